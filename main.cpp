@@ -7,11 +7,71 @@
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <cassert>
+#include <memory>
+#include <map>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <io.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 // Constants for game setup
 const unsigned int WINDOW_WIDTH = 1000;
 const unsigned int WINDOW_HEIGHT = 700;
 const std::string GAME_TITLE = "Code Blaster";
+const float FEEDBACK_DURATION = 1.5f;         // Seconds the Correct!/Incorrect! feedback stays up
+const float SIM_TIME_STEP = 1.f / 60.f;       // Length of one fixed simulation step, windowed and headless
+const float MAX_FRAME_TIME = 0.25f;           // Longer frames are clamped so a stall doesn't trigger a burst of steps
+const float AUTO_PLAYER_ACCURACY = 0.8f;      // Chance the headless auto player answers correctly
+const int MAX_OPTIONS = 4;                    // Answer boxes shown per question
+const int ASSET_UPLOADS_PER_FRAME = 2;        // Decoded assets moved to the GPU/audio device per frame
+const unsigned ATLAS_PAGE_SIZE = 2048;        // Width and maximum height of a sprite atlas page
+const unsigned ATLAS_PADDING = 1;             // Transparent gap between packed sprites
+const size_t MAX_BULLETS = 16384;             // Bullets alive at once; shots beyond this are dropped
+const size_t MAX_VOICES = 16;                 // Sound effects that can play at once
+const float MUSIC_VOLUME = 0.4f;              // Background music volume, 0..1
+const float EFFECTS_VOLUME = 1.f;             // Volume of VoicePool::SOUND_EFFECTS (correct answer), 0..1
+const float FEEDBACK_VOLUME = 1.f;            // Volume of VoicePool::SOUND_FEEDBACK (wrong answer buzzer), 0..1
+const float HIT_GRID_CELL_SIZE = 50.f;        // Cell size of the UI hit-test grid in pixels
+const float LEVEL_LIST_TOP = 65.f;            // Screen area of the scrolling level list
+const float LEVEL_LIST_BOTTOM = WINDOW_HEIGHT - 85.f;
+const float LEVEL_BUTTON_HEIGHT = 80.f;
+const float LEVEL_BUTTON_SPACING = 12.f;
+const float LEVEL_SCROLL_STEP = 60.f;         // Pixels per mouse wheel notch or arrow key press
+const float GLYPH_WARM_BUDGET = 0.004f;       // Seconds per frame spent prewarming glyphs while loading
+// Every character size used by the UI; bank and UI characters are prewarmed at each
+const unsigned UI_TEXT_SIZES[] = { 14, 20, 22, 24, 28, 30, 36, 40, 48, 60, 72 };
+const int BENCH_FRAMES = 1200;                // Frames measured per benchmark scenario and mode
+const double BENCH_TIME_TOLERANCE = 0.25;     // p95 frame time may exceed the baseline by this fraction
+const double BENCH_ALLOC_TOLERANCE = 0.5;     // Allocations per frame may exceed the baseline by this much
+const double BENCH_RSS_TOLERANCE = 0.25;      // Process peak RSS may exceed the baseline by this fraction
+const size_t PROFILER_HISTORY = 240;          // Frames shown in the profiler overlay graph
+const float PROFILER_TEXT_INTERVAL = 0.25f;   // Seconds between profiler overlay text refreshes
+const size_t MAX_PROFILER_FRAMES = 216000;    // Frames kept for --profile (an hour at 60 FPS)
 
 // assets locations 
 const std::string FONT_PATH = "C:/Users/HP/Desktop/Sfml project/resources/sansation.ttf";
@@ -23,258 +83,3480 @@ const std::string BACKGROUND_TEXTURE_PATH = "C:/Users/HP/Desktop/Code game OOps/
 const std::string HOME_IMAGE_PATH = "C:/Users/HP/Desktop/Code game OOps/Assests/spaceMeteors_002.png";
 const std::string SHOOTER_TEXTURE_PATH = "C:/Users/HP/Desktop/Code game OOps/Assests/spaceRockets_001.png";
 const std::string BULLET_TEXTURE_PATH = "C:/Users/HP/Desktop/Code game OOps/Assests/spaceMissiles_009.png";
+const std::string QUESTION_BANK_PATH = "C:/Users/HP/Desktop/Code game OOps/Assests/questions.txt";
+const std::string PROGRESS_PATH = "C:/Users/HP/Desktop/Code game OOps/progress.dat";
+const std::string JOURNAL_PATH = "C:/Users/HP/Desktop/Code game OOps/answers.journal";
+
+// --- AssetManager Class ---
+// Loads each texture, font and sound buffer file once and hands out shared handles.
+// The cache only keeps weak references, so an asset is freed as soon as nothing
+// uses it, and it records the memory use and load time of every file.
+// Async requests decode images and sounds on worker threads; the finished data is
+// uploaded on the render thread by pollUploads(), which also runs the callbacks.
+typedef std::shared_ptr<const sf::Texture> TextureHandle;
+typedef std::shared_ptr<const sf::Font> FontHandle;
+typedef std::shared_ptr<const sf::SoundBuffer> SoundBufferHandle;
+typedef std::shared_ptr<const sf::Image> ImageHandle;
+typedef std::function<void(bool)> AssetCallback;
+
+class AssetManager {
+public:
+    AssetManager() : stopping(false), requested(0), completed(0) {}
+
+    ~AssetManager() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    FontHandle getFont(const std::string& path) { return acquire<sf::Font>(path, "font"); }
+
+    // Return a handle right away and decode the file in the background. The texture stays
+    // empty until onReady(true) runs from pollUploads() on the render thread.
+    TextureHandle loadTextureAsync(const std::string& path, AssetCallback onReady) {
+        return requestAsync<sf::Texture>(path, "texture", Job::TEXTURE, onReady);
+    }
+
+    SoundBufferHandle loadSoundBufferAsync(const std::string& path, AssetCallback onReady) {
+        return requestAsync<sf::SoundBuffer>(path, "sound", Job::SOUND, onReady);
+    }
+
+    // Decode an image into CPU memory only, e.g. as input for a TextureAtlas
+    ImageHandle loadImageAsync(const std::string& path, AssetCallback onReady) {
+        return requestAsync<sf::Image>(path, "image", Job::IMAGE, onReady);
+    }
+
+    // Upload decoded assets and run their callbacks; call once per frame on the render thread
+    void pollUploads() {
+        for (int uploads = 0; uploads < ASSET_UPLOADS_PER_FRAME; ++uploads) {
+            std::shared_ptr<Job> job;
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (done.empty())
+                    break;
+                job = done.front();
+                done.pop_front();
+            }
+            finish(*job);
+        }
+    }
+
+    bool isLoading() const { return completed < requested; }
+
+    // Fraction of async requests finished since loading last went idle
+    float loadingProgress() const { return requested == 0 ? 1.f : float(completed) / float(requested); }
+
+    // Print one line per asset file: kind, estimated memory, load time and live handles
+    void printReport(std::ostream& out) const {
+        size_t liveBytes = 0;
+        double totalMs = 0.0;
+        out << "Assets:\n";
+        for (const auto& item : entries) {
+            const Entry& entry = item.second;
+            long uses = entry.asset.use_count();
+            if (uses > 0) liveBytes += entry.bytes;
+            totalMs += entry.loadMs;
+            out << "  " << entry.kind << "  " << entry.path << "\n"
+                << "      " << entry.bytes / 1024 << " KB, loaded in " << entry.loadMs << " ms, "
+                << (uses > 0 ? std::to_string(uses) + " handle(s)" : std::string("freed")) << "\n";
+        }
+        out << "  total: " << liveBytes / 1024 << " KB live, " << totalMs << " ms loading" << std::endl;
+    }
+
+private:
+    struct Job;
+
+    struct Entry {
+        const char* kind;
+        std::string path;
+        size_t bytes;
+        double loadMs;
+        std::weak_ptr<const void> asset;
+        std::shared_ptr<Job> pending;  // Set while an async load is in flight
+    };
+
+    // One async load: decoded on a worker, finished on the render thread
+    struct Job {
+        enum Kind { TEXTURE, SOUND, IMAGE };
+        Kind kind;
+        const char* label;
+        std::string key;
+        std::string path;
+        std::shared_ptr<sf::Texture> texture;
+        std::shared_ptr<sf::SoundBuffer> sound;
+        std::shared_ptr<sf::Image> imageAsset;
+        std::vector<AssetCallback> callbacks;
+        std::chrono::steady_clock::time_point start;
+        bool decoded;
+        sf::Image image;
+        std::vector<sf::Int16> samples;
+        unsigned int channelCount;
+        unsigned int sampleRate;
+    };
+
+    std::map<std::string, Entry> entries;
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool stopping;
+
+    std::deque<std::shared_ptr<Job>> done;
+    std::mutex doneMutex;
+
+    // Render-thread bookkeeping for the progress bar
+    int requested;
+    int completed;
+
+    static size_t memoryUsage(const sf::Texture& texture, const std::string&) {
+        return static_cast<size_t>(texture.getSize().x) * texture.getSize().y * 4;
+    }
+    static size_t memoryUsage(const sf::Image& image, const std::string&) {
+        return static_cast<size_t>(image.getSize().x) * image.getSize().y * 4;
+    }
+    static size_t memoryUsage(const sf::SoundBuffer& buffer, const std::string&) {
+        return static_cast<size_t>(buffer.getSampleCount()) * sizeof(sf::Int16);
+    }
+    static size_t memoryUsage(const sf::Font&, const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file ? static_cast<size_t>(file.tellg()) : 0;
+    }
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Return the live asset for this file or load it
+    template <typename T>
+    std::shared_ptr<const T> acquire(const std::string& path, const char* kind) {
+        std::string key = std::string(kind) + '|' + path;
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            std::shared_ptr<const void> live = it->second.asset.lock();
+            if (live)
+                return std::static_pointer_cast<const T>(live);
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        std::shared_ptr<T> asset = std::make_shared<T>();
+        if (!asset->loadFromFile(path)) {
+            std::cerr << "Error loading " << kind << ": " << path << std::endl;
+            return nullptr;
+        }
+        Entry entry;
+        entry.kind = kind;
+        entry.path = path;
+        entry.bytes = memoryUsage(*asset, path);
+        entry.loadMs = millisecondsSince(begin);
+        entry.asset = asset;
+        entries[key] = entry;
+        return asset;
+    }
+
+    // Share a live or in-flight asset, or queue a new decode job
+    template <typename T>
+    std::shared_ptr<const T> requestAsync(const std::string& path, const char* kind, typename Job::Kind jobKind,
+        AssetCallback onReady) {
+        std::string key = std::string(kind) + '|' + path;
+        Entry& entry = entries[key];
+        std::shared_ptr<const void> live = entry.asset.lock();
+        if (live && entry.pending) {
+            entry.pending->callbacks.push_back(onReady);
+            return std::static_pointer_cast<const T>(live);
+        }
+
+        requested++;
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        job->kind = jobKind;
+        job->label = kind;
+        job->key = key;
+        job->path = path;
+        job->callbacks.push_back(onReady);
+        job->start = std::chrono::steady_clock::now();
+        job->decoded = false;
+        job->channelCount = 0;
+        job->sampleRate = 0;
+
+        if (live) {
+            // Already loaded: report ready on the next pollUploads()
+            job->decoded = true;
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done.push_back(job);
+            return std::static_pointer_cast<const T>(live);
+        }
+
+        std::shared_ptr<T> asset = std::make_shared<T>();
+        assign(*job, asset);
+        entry.kind = kind;
+        entry.path = path;
+        entry.bytes = 0;
+        entry.loadMs = 0.0;
+        entry.asset = asset;
+        entry.pending = job;
+
+        startWorkers();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(job);
+        }
+        queueReady.notify_one();
+        return asset;
+    }
+
+    static void assign(Job& job, const std::shared_ptr<sf::Texture>& texture) { job.texture = texture; }
+    static void assign(Job& job, const std::shared_ptr<sf::SoundBuffer>& sound) { job.sound = sound; }
+    static void assign(Job& job, const std::shared_ptr<sf::Image>& image) { job.imageAsset = image; }
+
+    void startWorkers() {
+        if (!workers.empty())
+            return;
+        unsigned count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() - 1));
+        for (unsigned i = 0; i < count; ++i)
+            workers.emplace_back(&AssetManager::workerLoop, this);
+    }
+
+    // Decode files into CPU memory; anything touching OpenGL or OpenAL waits for the render thread
+    void workerLoop() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping)
+                    return;
+                job = queue.front();
+                queue.pop_front();
+            }
+
+            if (job->kind == Job::TEXTURE) {
+                job->decoded = job->image.loadFromFile(job->path);
+            }
+            else if (job->kind == Job::IMAGE) {
+                // Nobody reads the image until its callback runs, so decode straight into it
+                job->decoded = job->imageAsset->loadFromFile(job->path);
+            }
+            else {
+                sf::InputSoundFile file;
+                if (file.openFromFile(job->path)) {
+                    job->samples.resize(static_cast<size_t>(file.getSampleCount()));
+                    job->samples.resize(static_cast<size_t>(file.read(job->samples.data(), job->samples.size())));
+                    job->channelCount = file.getChannelCount();
+                    job->sampleRate = file.getSampleRate();
+                    job->decoded = true;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done.push_back(job);
+        }
+    }
+
+    // Upload a decoded job and notify everyone waiting on it
+    void finish(Job& job) {
+        bool ok = job.decoded;
+        if (ok && job.texture)
+            ok = job.texture->loadFromImage(job.image);
+        else if (ok && job.sound)
+            ok = job.sound->loadFromSamples(job.samples.data(), job.samples.size(), job.channelCount, job.sampleRate);
+        if (!ok && (job.texture || job.sound || job.imageAsset))
+            std::cerr << "Error loading " << job.label << ": " << job.path << std::endl;
+
+        Entry& entry = entries[job.key];
+        if (entry.pending.get() == &job) {
+            entry.pending.reset();
+            entry.loadMs = millisecondsSince(job.start);
+            if (!ok) entry.asset.reset();
+            else if (job.texture) entry.bytes = memoryUsage(*job.texture, job.path);
+            else if (job.sound) entry.bytes = memoryUsage(*job.sound, job.path);
+            else entry.bytes = memoryUsage(*job.imageAsset, job.path);
+        }
+        job.image = sf::Image();
+        std::vector<sf::Int16>().swap(job.samples);
+
+        completed++;
+        if (completed == requested)
+            completed = requested = 0;
+
+        for (const AssetCallback& callback : job.callbacks)
+            if (callback) callback(ok);
+    }
+};
+
+// --- Allocation Counters ---
+// Global operator new/delete are replaced to count heap allocations, so benchmarks
+// and the profiler can report allocations per frame and per phase. The counter is
+// per thread, so it costs no synchronisation and the asset loader and audio threads
+// don't show up in frame measurements.
+static thread_local uint64_t threadAllocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++threadAllocationCount;
+    for (;;) {
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        // Out of memory: let the installed new-handler free some, as the standard operator new does
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Heap allocations made by the calling thread so far
+inline uint64_t allocationsSoFar() {
+    return threadAllocationCount;
+}
+
+// Largest resident set the process has had so far, in bytes
+static size_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);        // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+#endif
+}
+
+// --- RenderStats ---
+// Draw calls and vertices submitted during the current frame, shown by the frame profiler
+struct RenderStats {
+    unsigned drawCalls;
+    size_t vertices;
+    unsigned textRebuilds; // CachedText changes that force new glyph geometry
+};
+static RenderStats renderStats = { 0, 0, 0 };
+
+// window.draw() wrappers that also count what was submitted
+inline void drawCounted(sf::RenderTarget& target, const sf::Shape& shape) {
+    target.draw(shape);
+    renderStats.drawCalls++;
+    renderStats.vertices += shape.getPointCount() + 2; // fill is a triangle fan
+    if (shape.getOutlineThickness() != 0.f) {
+        renderStats.drawCalls++;
+        renderStats.vertices += (shape.getPointCount() + 1) * 2;
+    }
+}
+inline void drawCounted(sf::RenderTarget& target, const sf::Text& text) {
+    target.draw(text);
+    renderStats.drawCalls++;
+    renderStats.vertices += text.getString().getSize() * 6; // upper bound, whitespace has no quad
+}
+inline void drawCounted(sf::RenderTarget& target, const sf::Sprite& sprite) {
+    target.draw(sprite);
+    renderStats.drawCalls++;
+    renderStats.vertices += 4;
+}
+inline void drawCounted(sf::RenderTarget& target, const sf::Vertex* vertices, size_t count,
+    sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default) {
+    target.draw(vertices, count, type, states);
+    renderStats.drawCalls++;
+    renderStats.vertices += count;
+}
+
+// --- FrameProfiler Class ---
+// Times named scopes inside each frame and counts the heap allocations made in them.
+// Keeps a short history for the F3 overlay (frame time graph, p50/p95/p99, per-phase
+// averages, draw calls, allocations) and, when
+// recording, a log of every scope that save() writes as CSV or as a Chrome
+// trace-event file (chrome://tracing, Perfetto) if the path ends in .json.
+class FrameProfiler {
+public:
+    // Times the enclosing block as the named phase; names must be string literals
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler_, const char* name) : profiler(profiler_), phase(profiler_.begin(name)) {}
+        ~Scope() { profiler.end(phase); }
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        FrameProfiler& profiler;
+        size_t phase;
+    };
+
+    FrameProfiler()
+        : origin(std::chrono::steady_clock::now()), frameStart(0), frameAllocStart(0), frameCount(0), recording(false),
+        overlay(false), mode("active"), textFont(nullptr), textAge(PROFILER_TEXT_INTERVAL), lastDrawCalls(0), lastVertices(0),
+        lastAllocations(0) {
+        frameMs.assign(PROFILER_HISTORY, 0.f);
+        frameAllocs.assign(PROFILER_HISTORY, 0.f);
+        textRebuilds.assign(PROFILER_HISTORY, 0.f);
+        graph.setPrimitiveType(sf::Quads);
+        scratch.reserve(PROFILER_HISTORY);
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Keep every scope of every frame in memory for save()
+    void startRecording() { recording = true; }
+    bool isRecording() const { return recording; }
+
+    void toggleOverlay() { overlay = !overlay; textAge = PROFILER_TEXT_INTERVAL; }
+
+    // Frame pacing mode shown in the overlay; the text refreshes at once when it changes
+    void setMode(const char* mode_) {
+        if (mode == mode_) return;
+        mode = mode_;
+        textAge = PROFILER_TEXT_INTERVAL;
+    }
+    bool overlayVisible() const { return overlay; }
+
+    void beginFrame() {
+        frameStart = now();
+        frameAllocStart = allocationsSoFar();
+        renderStats.drawCalls = 0;
+        renderStats.vertices = 0;
+        renderStats.textRebuilds = 0;
+        for (auto& phase : phases) {
+            phase.frameUs = 0;
+            phase.frameAllocs = 0;
+        }
+    }
+
+    void endFrame() {
+        uint64_t end = now();
+        float ms = (end - frameStart) / 1000.f;
+        size_t slot = frameCount % PROFILER_HISTORY;
+        frameMs[slot] = ms;
+        lastAllocations = allocationsSoFar() - frameAllocStart;
+        frameAllocs[slot] = static_cast<float>(lastAllocations);
+        for (auto& phase : phases) {
+            phase.history[slot] = phase.frameUs / 1000.f;
+            phase.allocHistory[slot] = static_cast<float>(phase.frameAllocs);
+        }
+        lastDrawCalls = renderStats.drawCalls;
+        lastVertices = renderStats.vertices;
+        textRebuilds[slot] = static_cast<float>(renderStats.textRebuilds);
+        textAge += ms / 1000.f;
+
+        if (recording && frames.size() < MAX_PROFILER_FRAMES) {
+            FrameRecord record = { frameStart, end - frameStart, lastDrawCalls, lastVertices, lastAllocations, events.size() };
+            frames.push_back(record);
+        }
+        else if (recording) {
+            std::cerr << "Warning: frame profile is full, later frames are not recorded.\n";
+            recording = false;
+        }
+        ++frameCount;
+    }
+
+    // Draw the overlay in the top-right corner; its text is refreshed a few times per second
+    void drawOverlay(sf::RenderTarget& target, const sf::Font& font) {
+        if (!overlay) return;
+        size_t valid = std::min<size_t>(frameCount, PROFILER_HISTORY);
+        if (valid == 0) return;
+
+        const float width = 300.f, graphHeight = 80.f;
+        const sf::Vector2f corner(WINDOW_WIDTH - width - 10.f, 10.f);
+        if (textFont != &font) {
+            textFont = &font;
+            text.setFont(font);
+            text.setCharacterSize(13);
+            text.setFillColor(sf::Color::White);
+        }
+        if (textAge >= PROFILER_TEXT_INTERVAL) {
+            textAge = 0.f;
+            refreshText(valid);
+        }
+        text.setPosition(corner.x + 8.f, corner.y + graphHeight + 12.f);
+
+        sf::FloatRect textBounds = text.getLocalBounds();
+        panel.setPosition(corner);
+        panel.setSize({ width, graphHeight + 20.f + textBounds.top + textBounds.height });
+        panel.setFillColor(sf::Color(0, 0, 0, 180));
+
+        // One bar per frame, oldest on the left; the line marks a 60 Hz frame
+        const float msScale = graphHeight / 50.f;
+        const float barWidth = (width - 16.f) / PROFILER_HISTORY;
+        const float baseY = corner.y + 8.f + graphHeight;
+        graph.resize((PROFILER_HISTORY + 1) * 4);
+        for (size_t i = 0; i < PROFILER_HISTORY; ++i) {
+            float ms = i < valid ? frameMs[(frameCount - valid + i) % PROFILER_HISTORY] : 0.f;
+            float h = std::min(ms * msScale, graphHeight);
+            float x = corner.x + 8.f + i * barWidth;
+            sf::Color color = ms > 1000.f / 30.f ? sf::Color::Red : ms > 1000.f / 60.f + 0.5f ? sf::Color::Yellow : sf::Color::Green;
+            sf::Vertex* quad = &graph[i * 4];
+            quad[0] = sf::Vertex({ x, baseY - h }, color);
+            quad[1] = sf::Vertex({ x + barWidth, baseY - h }, color);
+            quad[2] = sf::Vertex({ x + barWidth, baseY }, color);
+            quad[3] = sf::Vertex({ x, baseY }, color);
+        }
+        float targetY = baseY - (1000.f / 60.f) * msScale;
+        sf::Vertex* line = &graph[PROFILER_HISTORY * 4];
+        line[0] = sf::Vertex({ corner.x + 8.f, targetY - 0.5f }, sf::Color::White);
+        line[1] = sf::Vertex({ corner.x + width - 8.f, targetY - 0.5f }, sf::Color::White);
+        line[2] = sf::Vertex({ corner.x + width - 8.f, targetY + 0.5f }, sf::Color::White);
+        line[3] = sf::Vertex({ corner.x + 8.f, targetY + 0.5f }, sf::Color::White);
+
+        target.draw(panel);
+        target.draw(graph);
+        target.draw(text);
+    }
+
+    // Write the recorded frames; CSV has one row per frame, .json is a Chrome trace
+    bool save(const std::string& path) const {
+        std::ofstream file(path.c_str());
+        if (!file) {
+            std::cerr << "Error writing frame profile: " << path << std::endl;
+            return false;
+        }
+        bool trace = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        if (trace)
+            writeTrace(file);
+        else
+            writeCsv(file);
+        std::cout << "Wrote " << frames.size() << " profiled frames to " << path << std::endl;
+        return static_cast<bool>(file);
+    }
+
+private:
+    struct Phase {
+        const char* name;
+        uint64_t frameUs;                 // time spent in this phase during the current frame
+        uint64_t frameAllocs;             // heap allocations in this phase during the current frame
+        std::vector<float> history;       // ms per frame, same ring layout as frameMs
+        std::vector<float> allocHistory;  // allocations per frame, same layout
+        std::vector<uint64_t> open;       // start times of active (possibly nested) scopes
+        std::vector<uint64_t> openAllocs; // allocation counts when those scopes started
+    };
+    struct Event {
+        uint32_t phase;
+        uint32_t depth;
+        uint64_t startUs;
+        uint64_t durationUs;
+        uint64_t allocations;
+    };
+    struct FrameRecord {
+        uint64_t startUs;
+        uint64_t durationUs;
+        unsigned drawCalls;
+        size_t vertices;
+        uint64_t allocations;
+        size_t lastEvent; // events [previous frame's lastEvent, lastEvent) belong to this frame
+    };
+
+    std::chrono::steady_clock::time_point origin;
+    uint64_t frameStart;
+    uint64_t frameAllocStart;
+    size_t frameCount;
+    std::vector<float> frameMs;
+    std::vector<float> frameAllocs;
+    std::vector<float> textRebuilds;
+    std::vector<Phase> phases;
+    std::vector<Event> events;
+    std::vector<FrameRecord> frames;
+    bool recording;
+    uint32_t depth = 0;
+
+    bool overlay;
+    const char* mode;
+    const sf::Font* textFont;
+    float textAge;
+    unsigned lastDrawCalls;
+    size_t lastVertices;
+    uint64_t lastAllocations;
+    std::vector<float> scratch;
+    sf::RectangleShape panel;
+    sf::VertexArray graph;
+    sf::Text text;
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - origin).count());
+    }
+
+    size_t begin(const char* name) {
+        size_t index = 0;
+        while (index < phases.size() && phases[index].name != name)
+            ++index;
+        if (index == phases.size()) {
+            Phase phase;
+            phase.name = name;
+            phase.frameUs = 0;
+            phase.frameAllocs = 0;
+            phase.history.assign(PROFILER_HISTORY, 0.f);
+            phase.allocHistory.assign(PROFILER_HISTORY, 0.f);
+            phases.push_back(phase);
+        }
+        phases[index].open.push_back(now());
+        phases[index].openAllocs.push_back(allocationsSoFar());
+        ++depth;
+        return index;
+    }
+
+    void end(size_t index) {
+        Phase& phase = phases[index];
+        uint64_t start = phase.open.back();
+        uint64_t allocations = allocationsSoFar() - phase.openAllocs.back();
+        phase.open.pop_back();
+        phase.openAllocs.pop_back();
+        uint64_t duration = now() - start;
+        --depth;
+        if (phase.open.empty()) { // don't count recursive scopes twice
+            phase.frameUs += duration;
+            phase.frameAllocs += allocations;
+        }
+        if (recording) {
+            Event event = { static_cast<uint32_t>(index), depth, start, duration, allocations };
+            events.push_back(event);
+        }
+    }
+
+    float percentile(float p) {
+        size_t n = static_cast<size_t>(p * (scratch.size() - 1) + 0.5f);
+        std::nth_element(scratch.begin(), scratch.begin() + n, scratch.end());
+        return scratch[n];
+    }
+
+    void refreshText(size_t valid) {
+        scratch.assign(frameMs.begin(), frameMs.begin() + valid);
+        float total = 0.f;
+        for (float ms : scratch) total += ms;
+        float average = total / valid;
+
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(2);
+        out << "Frame " << average << " ms (" << static_cast<int>(1000.f / std::max(average, 0.001f)) << " FPS)\n";
+        out << "Mode " << mode << "\n";
+        float p50 = percentile(0.50f), p95 = percentile(0.95f), p99 = percentile(0.99f);
+        out << "p50 " << p50 << "  p95 " << p95 << "  p99 " << p99 << " ms\n";
+        out << "Draw calls " << lastDrawCalls << ", vertices " << lastVertices << "\n";
+        float rebuilt = 0.f;
+        for (size_t i = 0; i < valid; ++i) rebuilt += textRebuilds[i];
+        out << "Text rebuilds " << static_cast<int>(rebuilt) << " in " << valid << " frames\n";
+        float allocs = 0.f, worstAllocs = 0.f;
+        for (size_t i = 0; i < valid; ++i) {
+            allocs += frameAllocs[i];
+            worstAllocs = std::max(worstAllocs, frameAllocs[i]);
+        }
+        out << "Allocations " << allocs / valid << " avg, " << static_cast<int>(worstAllocs) << " max\n";
+        for (const auto& phase : phases) {
+            float sum = 0.f, worst = 0.f, phaseAllocs = 0.f;
+            for (size_t i = 0; i < valid; ++i) {
+                sum += phase.history[i];
+                worst = std::max(worst, phase.history[i]);
+                phaseAllocs += phase.allocHistory[i];
+            }
+            out << phase.name << "  " << sum / valid << " avg, " << worst << " max";
+            if (phaseAllocs > 0.f)
+                out << ", " << phaseAllocs / valid << " allocs";
+            out << "\n";
+        }
+        text.setString(out.str());
+    }
+
+    void writeCsv(std::ostream& file) const {
+        file << "frame,start_ms,frame_ms,draw_calls,vertices,allocations";
+        for (const auto& phase : phases)
+            file << ',' << phase.name << "_ms";
+        for (const auto& phase : phases)
+            file << ',' << phase.name << "_allocs";
+        file << '\n';
+
+        std::vector<uint64_t> phaseUs(phases.size());
+        std::vector<uint64_t> phaseAllocs(phases.size());
+        size_t firstEvent = 0;
+        for (size_t f = 0; f < frames.size(); ++f) {
+            const FrameRecord& frame = frames[f];
+            std::fill(phaseUs.begin(), phaseUs.end(), 0);
+            std::fill(phaseAllocs.begin(), phaseAllocs.end(), 0);
+            for (size_t e = firstEvent; e < frame.lastEvent; ++e) {
+                phaseUs[events[e].phase] += events[e].durationUs;
+                phaseAllocs[events[e].phase] += events[e].allocations;
+            }
+            firstEvent = frame.lastEvent;
+
+            file << f << ',' << frame.startUs / 1000.0 << ',' << frame.durationUs / 1000.0 << ','
+                << frame.drawCalls << ',' << frame.vertices << ',' << frame.allocations;
+            for (uint64_t us : phaseUs)
+                file << ',' << us / 1000.0;
+            for (uint64_t allocs : phaseAllocs)
+                file << ',' << allocs;
+            file << '\n';
+        }
+    }
+
+    void writeTrace(std::ostream& file) const {
+        file << "{\"traceEvents\":[\n";
+        size_t firstEvent = 0;
+        for (size_t f = 0; f < frames.size(); ++f) {
+            const FrameRecord& frame = frames[f];
+            file << (f ? ",\n" : "") << "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << frame.startUs
+                << ",\"dur\":" << frame.durationUs << ",\"args\":{\"draw_calls\":" << frame.drawCalls
+                << ",\"vertices\":" << frame.vertices << ",\"allocations\":" << frame.allocations << "}}";
+            for (size_t e = firstEvent; e < frame.lastEvent; ++e) {
+                file << ",\n{\"name\":\"" << phases[events[e].phase].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                    << events[e].startUs << ",\"dur\":" << events[e].durationUs
+                    << ",\"args\":{\"allocations\":" << events[e].allocations << "}}";
+            }
+            firstEvent = frame.lastEvent;
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+};
+
+// --- TextureAtlas Class ---
+// Packs sprite images into a few large textures at load time, so sprites that share
+// a page can be drawn one after another without switching textures. Images are
+// decoded by the AssetManager workers; packing and upload happen on the render thread
+// once the last one arrives, after which the source images are released.
+class TextureAtlas {
+public:
+    // Where a named sprite ended up
+    struct Region {
+        const sf::Texture* texture;
+        sf::IntRect rect;
+    };
+
+    TextureAtlas() : pending(0) {}
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Queue named sprite files; onReady runs once the atlas has been built
+    void load(AssetManager& assets, const std::vector<std::pair<std::string, std::string>>& sprites, AssetCallback onReady) {
+        callback = onReady;
+        pending = static_cast<int>(sprites.size());
+        for (const auto& sprite : sprites) {
+            names.push_back(sprite.first);
+            images.push_back(assets.loadImageAsync(sprite.second, [this](bool) {
+                if (--pending == 0)
+                    build();
+            }));
+        }
+    }
+
+    const Region* find(const std::string& name) const {
+        auto it = regions.find(name);
+        return it != regions.end() ? &it->second : nullptr;
+    }
+
+private:
+    std::vector<std::string> names;
+    std::vector<ImageHandle> images;
+    std::vector<std::unique_ptr<sf::Texture>> pages;
+    std::map<std::string, Region> regions;
+    AssetCallback callback;
+    int pending;
+
+    // Shelf-pack the images tallest first, opening a new page when one fills up
+    void build() {
+        std::vector<size_t> order;
+        for (size_t i = 0; i < images.size(); ++i)
+            if (images[i]->getSize().x > 0)
+                order.push_back(i);
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return images[a]->getSize().y > images[b]->getSize().y;
+        });
+
+        const unsigned pageSize = std::min(ATLAS_PAGE_SIZE, sf::Texture::getMaximumSize());
+        std::vector<sf::Image> pageImages;
+        std::vector<unsigned> pageHeights;
+        std::vector<std::pair<size_t, sf::Vector2u>> placements(images.size());
+        unsigned x = 0, y = 0, shelfHeight = 0;
+
+        for (size_t i : order) {
+            sf::Vector2u size = images[i]->getSize();
+            if (size.x > pageSize || size.y > pageSize) {
+                std::cerr << "Warning: sprite " << names[i] << " is larger than an atlas page.\n";
+                continue;
+            }
+            if (x + size.x > pageSize) {
+                x = 0;
+                y += shelfHeight + ATLAS_PADDING;
+                shelfHeight = 0;
+            }
+            if (pageHeights.empty() || y + size.y > pageSize) {
+                pageHeights.push_back(0);
+                x = y = shelfHeight = 0;
+            }
+            placements[i] = std::make_pair(pageHeights.size() - 1, sf::Vector2u(x, y));
+            pageHeights.back() = std::max(pageHeights.back(), y + size.y);
+            x += size.x + ATLAS_PADDING;
+            shelfHeight = std::max(shelfHeight, size.y);
+        }
+
+        pageImages.resize(pageHeights.size());
+        for (size_t p = 0; p < pageImages.size(); ++p)
+            pageImages[p].create(pageSize, pageHeights[p], sf::Color::Transparent);
+        for (size_t i : order) {
+            if (images[i]->getSize().x > pageSize || images[i]->getSize().y > pageSize)
+                continue;
+            pageImages[placements[i].first].copy(*images[i], placements[i].second.x, placements[i].second.y);
+        }
+
+        bool ok = true;
+        for (const sf::Image& image : pageImages) {
+            pages.push_back(std::unique_ptr<sf::Texture>(new sf::Texture()));
+            ok = pages.back()->loadFromImage(image) && ok;
+        }
+        for (size_t i : order) {
+            if (images[i]->getSize().x > pageSize || images[i]->getSize().y > pageSize)
+                continue;
+            Region region;
+            region.texture = pages[placements[i].first].get();
+            region.rect = sf::IntRect(placements[i].second.x, placements[i].second.y,
+                images[i]->getSize().x, images[i]->getSize().y);
+            regions[names[i]] = region;
+        }
+
+        images.clear();
+        if (callback)
+            callback(ok);
+    }
+};
+
+// --- SpriteBatch Class ---
+// Collects textured quads during a frame and draws them with one draw call per
+// texture. Quads keep their submission order within a texture; since game sprites
+// share an atlas page this is usually a single call. Vertex storage is reused
+// between frames, so a steady frame does not allocate.
+class SpriteBatch {
+public:
+    // Queue a sprite with its full transform, texture rect and color
+    void add(const sf::Sprite& sprite) {
+        if (!sprite.getTexture()) return;
+        const sf::IntRect& rect = sprite.getTextureRect();
+        const sf::Transform& transform = sprite.getTransform();
+        float w = static_cast<float>(std::abs(rect.width));
+        float h = static_cast<float>(std::abs(rect.height));
+        pushQuad(*sprite.getTexture(), rect,
+            transform.transformPoint(0.f, 0.f), transform.transformPoint(w, 0.f),
+            transform.transformPoint(w, h), transform.transformPoint(0.f, h), sprite.getColor());
+    }
+
+    // Queue an unrotated, unscaled quad with its top-left corner at position
+    void add(const sf::Texture& texture, const sf::IntRect& rect, sf::Vector2f position, sf::Color color = sf::Color::White) {
+        float w = static_cast<float>(rect.width);
+        float h = static_cast<float>(rect.height);
+        pushQuad(texture, rect, position, sf::Vector2f(position.x + w, position.y),
+            sf::Vector2f(position.x + w, position.y + h), sf::Vector2f(position.x, position.y + h), color);
+    }
+
+    // Make room for quads of this texture up front, so the first busy frames don't grow the batch
+    void reserve(const sf::Texture& texture, size_t quads) {
+        verticesFor(texture).reserve(quads * 4);
+    }
+
+    // Draw everything queued since the last flush and start a new batch
+    void flush(sf::RenderTarget& target) {
+        for (auto& batch : batches) {
+            if (batch.vertices.empty()) continue;
+            sf::RenderStates states(batch.texture);
+            drawCounted(target, &batch.vertices[0], batch.vertices.size(), sf::Quads, states);
+            batch.vertices.clear();
+        }
+    }
+
+private:
+    struct Batch {
+        const sf::Texture* texture;
+        std::vector<sf::Vertex> vertices;
+    };
+    std::vector<Batch> batches;
+
+    std::vector<sf::Vertex>& verticesFor(const sf::Texture& texture) {
+        for (auto& batch : batches)
+            if (batch.texture == &texture)
+                return batch.vertices;
+        batches.push_back(Batch());
+        batches.back().texture = &texture;
+        return batches.back().vertices;
+    }
+
+    void pushQuad(const sf::Texture& texture, const sf::IntRect& rect, sf::Vector2f topLeft, sf::Vector2f topRight,
+        sf::Vector2f bottomRight, sf::Vector2f bottomLeft, sf::Color color) {
+        std::vector<sf::Vertex>& vertices = verticesFor(texture);
+        float left = static_cast<float>(rect.left);
+        float top = static_cast<float>(rect.top);
+        float right = left + rect.width;
+        float bottom = top + rect.height;
+        vertices.push_back(sf::Vertex(topLeft, color, sf::Vector2f(left, top)));
+        vertices.push_back(sf::Vertex(topRight, color, sf::Vector2f(right, top)));
+        vertices.push_back(sf::Vertex(bottomRight, color, sf::Vector2f(right, bottom)));
+        vertices.push_back(sf::Vertex(bottomLeft, color, sf::Vector2f(left, bottom)));
+    }
+};
+
+// --- BulletPool Class ---
+// Fixed-capacity bullet storage kept as parallel arrays of centre positions and
+// speeds. Storage is allocated once; removing a bullet moves the last one into its
+// slot, so the live bullets always occupy [0, count). Sprites are not stored at all,
+// quads are generated from the positions when the pool is drawn. The position before
+// the last step is kept too, so rendering can interpolate between simulation steps.
+class BulletPool {
+public:
+    explicit BulletPool(size_t capacity_ = MAX_BULLETS)
+        : x(capacity_), y(capacity_), prevY(capacity_), speed(capacity_), count(0) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return x.size(); }
+
+    // Add a bullet centred at position; returns false if the pool is full
+    bool spawn(sf::Vector2f position, float speed_) {
+        if (count == x.size()) return false;
+        x[count] = position.x;
+        y[count] = position.y;
+        prevY[count] = position.y;
+        speed[count] = speed_;
+        ++count;
+        return true;
+    }
+
+    // Move every bullet upward by speed (pixels per second) * dt, then drop the ones above the window
+    void update(float dt) {
+        float* py = y.data();
+        float* pprev = prevY.data();
+        const float* ps = speed.data();
+        const size_t n = count;
+        for (size_t i = 0; i < n; ++i) { // no branches or aliasing, so the compiler can vectorize this
+            pprev[i] = py[i];
+            py[i] -= ps[i] * dt;
+        }
+
+        for (size_t i = 0; i < count;) {
+            if (y[i] < 0.f) { // Off screen if above window
+                --count;
+                x[i] = x[count];
+                y[i] = y[count];
+                prevY[i] = prevY[count];
+                speed[i] = speed[count];
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+    void clear() { count = 0; }
+
+    // Queue one quad per bullet using the given atlas region; alpha blends from the
+    // previous step's position (0) to the current one (1)
+    void draw(SpriteBatch& batch, const TextureAtlas::Region& region, float alpha) const {
+        const float halfWidth = region.rect.width / 2.f;
+        const float halfHeight = region.rect.height / 2.f;
+        for (size_t i = 0; i < count; ++i) {
+            float drawY = prevY[i] + (y[i] - prevY[i]) * alpha;
+            batch.add(*region.texture, region.rect, sf::Vector2f(x[i] - halfWidth, drawY - halfHeight));
+        }
+    }
+
+private:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> prevY;
+    std::vector<float> speed;
+    size_t count;
+};
+
+// --- Shooter Class ---
+// Player's shooter entity with bullet firing capability
+class Shooter {
+public:
+    sf::Sprite sprite;
+    TextureAtlas::Region bulletRegion;
+    BulletPool bullets;
+    float bulletSpeed;
+    bool hasSprites;
+
+    Shooter() : bulletSpeed(600.f), hasSprites(false) {
+        sprite.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT - 100);
+    }
+
+    // Shooter and bullet sprites taken from the sprite atlas
+    void setSprites(const TextureAtlas::Region& shooterRegion, const TextureAtlas::Region& bullet) {
+        sprite.setTexture(*shooterRegion.texture);
+        sprite.setTextureRect(shooterRegion.rect);
+        sprite.setOrigin(shooterRegion.rect.width / 2.f, shooterRegion.rect.height / 2.f);
+        bulletRegion = bullet;
+        hasSprites = true;
+    }
+
+    // Create a new bullet at the tip of the shooter
+    void shoot() {
+        if (!hasSprites) return;
+        bullets.spawn({ sprite.getPosition().x, sprite.getPosition().y - sprite.getGlobalBounds().height / 2.f }, bulletSpeed);
+    }
+
+    // Update bullets' position and remove off-screen bullets
+    void update(float dt) {
+        bullets.update(dt);
+    }
+
+    // Queue shooter and all bullets, interpolated alpha of the way into the next step
+    void draw(SpriteBatch& batch, float alpha) const {
+        batch.add(sprite);
+        if (hasSprites)
+            bullets.draw(batch, bulletRegion, alpha);
+    }
+};
+
+// --- Button Class ---
+// UI Button with support for multi-line text and hover/disabled states
+class Button {
+public:
+    sf::RectangleShape rect;
+    std::vector<sf::Text> textLines;
+    const sf::Font& font;
+    unsigned int charSize;
+    sf::Color idleColor = sf::Color(70, 70, 150);
+    sf::Color hoverColor = sf::Color(120, 120, 220);
+    sf::Color textColor = sf::Color::White;
+    sf::Color disabledColor = sf::Color(50, 50, 100);
+    sf::Color disabledTextColor = sf::Color(110, 110, 160);
+    bool enabled = true;
+    bool hovered = false;
+    sf::FloatRect bounds; // World bounds, cached until the button is moved
+    size_t lineCount = 0; // textLines beyond this are spare lines kept for relabeling
+
+    // Constructor to create button with size, position, text, font and character size
+    Button(sf::Vector2f size, sf::Vector2f position, const std::string& buttonText, const sf::Font& btnFont, unsigned int charSize_ = 20)
+        : font(btnFont), charSize(charSize_)
+    {
+        rect.setSize(size);
+        rect.setFillColor(idleColor);
+        rect.setOrigin(size.x / 2.f, size.y / 2.f);
+        setLabel(buttonText);
+        setPosition(position);
+    }
+
+    // Replace the label, one sf::Text per line. Existing lines are reused, so a
+    // recycled button only allocates when a label has more lines than any before it.
+    void setLabel(const std::string& buttonText) {
+        lineCount = 0;
+        size_t start = 0;
+        while (start < buttonText.size()) {
+            size_t end = buttonText.find('\n', start);
+            if (end == std::string::npos) end = buttonText.size();
+            if (lineCount == textLines.size()) {
+                textLines.push_back(sf::Text());
+                textLines.back().setFont(font);
+                textLines.back().setCharacterSize(charSize);
+            }
+            sf::Text& textLine = textLines[lineCount++];
+            textLine.setString(buttonText.substr(start, end - start));
+            sf::FloatRect lineBounds = textLine.getLocalBounds();
+            textLine.setOrigin(lineBounds.left + lineBounds.width / 2.f, lineBounds.top + lineBounds.height / 2.f);
+            start = end + 1;
+        }
+        applyColors();
+        layoutLines();
+    }
+
+    // Move the button (centre) along with its label
+    void setPosition(sf::Vector2f position) {
+        rect.setPosition(position);
+        bounds = rect.getGlobalBounds();
+        layoutLines();
+    }
+
+    // Update hover state for the mouse position; colors are only touched if it changed
+    bool updateHover(const sf::Vector2i& mousePos) {
+        return setHovered(isMouseOver(mousePos));
+    }
+
+    // Set hover state directly, e.g. from a HitGrid lookup; disabled buttons never hover
+    bool setHovered(bool value) {
+        value = value && enabled;
+        if (value == hovered) return false;
+        hovered = value;
+        applyColors();
+        return true;
+    }
+
+    // Set button and text colors from enabled and hover state
+    void applyColors() {
+        if (!enabled) {
+            rect.setFillColor(disabledColor);
+            for (auto& t : textLines) t.setFillColor(disabledTextColor);
+        }
+        else {
+            rect.setFillColor(hovered ? hoverColor : idleColor);
+            for (auto& t : textLines) t.setFillColor(textColor);
+        }
+    }
+
+    // Check if mouse is over button (only if enabled)
+    bool isMouseOver(const sf::Vector2i& mousePos) const {
+        sf::Vector2f mf(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
+        return enabled && bounds.contains(mf);
+    }
+
+    // Draw button rectangle and text lines
+    void draw(sf::RenderTarget& target) const {
+        drawCounted(target, rect);
+        for (size_t i = 0; i < lineCount; ++i) drawCounted(target, textLines[i]);
+    }
+
+    // Enable or disable button and update color accordingly
+    void setEnabled(bool val) {
+        enabled = val;
+        hovered = false;
+        applyColors();
+    }
+
+private:
+    // Position each text line vertically centered in button
+    void layoutLines() {
+        float lineHeight = charSize * 1.3f;
+        float totalHeight = lineCount * lineHeight;
+        sf::Vector2f position = rect.getPosition();
+        float startY = position.y - totalHeight / 2.f + lineHeight / 2.f;
+        for (size_t i = 0; i < lineCount; ++i)
+            textLines[i].setPosition(position.x, startY + i * lineHeight);
+    }
+};
+
+// --- HitGrid Class ---
+// Uniform grid over the window for mouse hit-testing. A widget's world bounds are
+// cached when it is added and its id is stored in every cell those bounds overlap,
+// so a lookup only tests the few widgets in the cell under the point, however many
+// widgets are registered.
+class HitGrid {
+public:
+    explicit HitGrid(float cellSize_ = HIT_GRID_CELL_SIZE)
+        : cellSize(cellSize_),
+        columns(static_cast<int>(WINDOW_WIDTH / cellSize_) + 1),
+        rows(static_cast<int>(WINDOW_HEIGHT / cellSize_) + 1),
+        cells(columns * rows) {}
+
+    // Remove every widget; cell storage is kept for the next layout
+    void clear() {
+        for (auto& cell : cells) cell.clear();
+        bounds.clear();
+    }
+
+    // Register a widget's world bounds under a small non-negative id
+    void add(int id, const sf::FloatRect& rect) {
+        if (static_cast<size_t>(id) >= bounds.size())
+            bounds.resize(id + 1);
+        bounds[id] = rect;
+        int x0 = cellColumn(rect.left), x1 = cellColumn(rect.left + rect.width);
+        int y0 = cellRow(rect.top), y1 = cellRow(rect.top + rect.height);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                cells[y * columns + x].push_back(id);
+    }
+
+    // Id of the most recently added widget containing point, or -1
+    int find(sf::Vector2f point) const {
+        if (point.x < 0.f || point.y < 0.f || point.x >= WINDOW_WIDTH || point.y >= WINDOW_HEIGHT)
+            return -1;
+        const std::vector<int>& cell = cells[cellRow(point.y) * columns + cellColumn(point.x)];
+        for (auto it = cell.rbegin(); it != cell.rend(); ++it)
+            if (bounds[*it].contains(point))
+                return *it;
+        return -1;
+    }
+
+private:
+    float cellSize;
+    int columns;
+    int rows;
+    std::vector<std::vector<int>> cells;
+    std::vector<sf::FloatRect> bounds;
+
+    int cellColumn(float x) const { return std::max(0, std::min(columns - 1, static_cast<int>(x / cellSize))); }
+    int cellRow(float y) const { return std::max(0, std::min(rows - 1, static_cast<int>(y / cellSize))); }
+};
+
+// --- CachedText Class ---
+// Retained sf::Text for labels that change at runtime. sf::Text rebuilds its glyph
+// geometry after every setString/setCharacterSize/setFont, even when the value is
+// the same, so these setters compare first and only touch the text on a real change.
+// Local bounds are cached, and the origin follows an anchor (0..1 of the bounds) so
+// centred labels stay centred without re-measuring every frame.
+class CachedText {
+public:
+    CachedText() : anchorX(0.f), anchorY(0.f), boundsDirty(true) {}
+
+    void setFont(const sf::Font& font) {
+        if (text.getFont() == &font) return;
+        text.setFont(font);
+        invalidate();
+    }
+
+    void setString(const std::string& value) {
+        if (value == current) return;
+        current = value;
+        text.setString(value);
+        invalidate();
+    }
+
+    // Formatted labels pass a stack buffer; an unchanged label costs a compare and no allocation
+    void setString(const char* value) {
+        if (current == value) return;
+        current = value;
+        text.setString(value);
+        invalidate();
+    }
+
+    void setCharacterSize(unsigned size) {
+        if (text.getCharacterSize() == size) return;
+        text.setCharacterSize(size);
+        invalidate();
+    }
+
+    void setFillColor(sf::Color color) {
+        if (text.getFillColor() != color) text.setFillColor(color); // color only touches vertex colors
+    }
+
+    void setPosition(float x, float y) { text.setPosition(x, y); }
+    void setPosition(sf::Vector2f position) { text.setPosition(position); }
+
+    // Place the origin at this fraction of the bounds, e.g. (0.5, 0.5) centres the text on its position
+    void setAnchor(float x, float y) {
+        anchorX = x;
+        anchorY = y;
+        updateOrigin();
+    }
+
+    const std::string& getString() const { return current; }
+
+    const sf::FloatRect& getLocalBounds() const {
+        if (boundsDirty) {
+            bounds = text.getLocalBounds();
+            boundsDirty = false;
+        }
+        return bounds;
+    }
+
+    const sf::Text& getText() const { return text; }
+
+private:
+    sf::Text text;
+    std::string current;
+    float anchorX, anchorY;
+    mutable sf::FloatRect bounds;
+    mutable bool boundsDirty;
+
+    void invalidate() {
+        boundsDirty = true;
+        renderStats.textRebuilds++;
+        updateOrigin();
+    }
+
+    void updateOrigin() {
+        const sf::FloatRect& b = getLocalBounds();
+        text.setOrigin(b.left + b.width * anchorX, b.top + b.height * anchorY);
+    }
+};
+
+inline void drawCounted(sf::RenderTarget& target, const CachedText& text) {
+    drawCounted(target, text.getText());
+}
+
+// --- ScreenCache Class ---
+// Keeps the last composited frame of a mostly static screen in a render texture, so
+// it can be drawn as one quad until something on it changes. The cache belongs to
+// one screen at a time; switching screens or calling invalidate() forces a redraw.
+class ScreenCache {
+public:
+    ScreenCache() : ready(false), dirty(true), screen(-1) {}
+
+    // Returns false if render textures aren't supported; the caller then draws directly
+    bool create(unsigned width, unsigned height) {
+        ready = texture.create(width, height);
+        if (ready)
+            sprite.setTexture(texture.getTexture(), true);
+        return ready;
+    }
+
+    bool isReady() const { return ready; }
+    void invalidate() { dirty = true; }
+
+    // True if the cached image is stale or belongs to another screen
+    bool needsRedraw(int screen_) const { return dirty || screen != screen_; }
+
+    // Target to composite the screen into; call finish() once it is drawn
+    sf::RenderTarget& target() { return texture; }
+
+    void finish(int screen_) {
+        texture.display();
+        dirty = false;
+        screen = screen_;
+    }
+
+    void draw(sf::RenderTarget& target_) const { drawCounted(target_, sprite); }
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    bool ready;
+    bool dirty;
+    int screen;
+};
+
+// --- GlyphWarmer Class ---
+// Rasterizes glyphs ahead of time so a question with characters not seen before doesn't
+// hitch while FreeType renders them. Characters are gathered from text (the question
+// bank and the UI strings) and every one is loaded at every size the UI uses, a few
+// milliseconds per frame while the loading screen shows. sf::Font keeps the glyphs in
+// its page textures from then on.
+class GlyphWarmer {
+public:
+    GlyphWarmer() : font(nullptr), next(0) { clearCharacters(); }
+
+    void clearCharacters() { std::fill(seen, seen + 256, false); }
+
+    // Note every character in text. Bytes are widened the way sf::Text::setString(std::string)
+    // does it, so the warmed glyphs are exactly the ones labels will ask for.
+    void addCharacters(const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i)
+            seen[static_cast<unsigned char>(data[i])] = true;
+    }
+
+    // Queue every noted character at each of the sizes for font
+    void start(const sf::Font& font_, const unsigned* sizes, size_t sizeCount) {
+        font = &font_;
+        std::string bytes;
+        for (int c = 0; c < 256; ++c)
+            if (seen[c] && c >= 32) bytes += static_cast<char>(c);
+        sf::String characters(bytes);
+        pending.clear();
+        for (size_t s = 0; s < sizeCount; ++s)
+            for (sf::Uint32 codepoint : characters)
+                pending.push_back(std::make_pair(codepoint, sizes[s]));
+        next = 0;
+    }
+
+    // Load queued glyphs until the time budget runs out; returns true once all are loaded
+    bool step(float budgetSeconds) {
+        auto start = std::chrono::steady_clock::now();
+        while (next < pending.size()) {
+            font->getGlyph(pending[next].first, pending[next].second, false);
+            ++next;
+            if ((next & 15) == 0 && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= budgetSeconds)
+                break;
+        }
+        return done();
+    }
+
+    bool done() const { return next >= pending.size(); }
+    float progress() const { return pending.empty() ? 1.f : float(next) / float(pending.size()); }
+
+private:
+    const sf::Font* font;
+    bool seen[256];
+    std::vector<std::pair<sf::Uint32, unsigned>> pending; // codepoint, character size
+    size_t next;
+};
+
+// --- TextView Struct ---
+// Non-owning view of a string in the question bank's string pool
+struct TextView {
+    const char* data;
+    size_t size;
+
+    std::string str() const { return std::string(data, size); }
+};
+
+// --- Question Struct ---
+// Represents a multiple-choice question for a level. Plain record laid out exactly
+// as in the binary bank file: the question text and its options sit back to back
+// in the string pool starting at textOffset.
+struct Question {
+    uint32_t textOffset;
+    uint16_t textLength;
+    uint16_t optionLength[MAX_OPTIONS];
+    uint8_t optionCount;
+    int8_t correctOptionIndex;
+};
+
+// --- Level Struct ---
+// Represents a level as a contiguous run of questions in the bank
+struct Level {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t firstQuestion;
+    uint32_t questionCount;
+};
+
+// --- QuestionBankHeader Struct ---
+// Binary bank layout (little-endian): header, Level records, Question records, string pool.
+// The checksum is FNV-1a over everything after the header.
+struct QuestionBankHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t questionCount;
+    uint32_t poolSize;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(Question) == 8 + 2 * MAX_OPTIONS && sizeof(Level) == 16 && sizeof(QuestionBankHeader) == 24,
+    "question bank records must have no padding");
+
+const char QUESTION_BANK_MAGIC[4] = { 'C', 'B', 'Q', 'B' };
+const uint32_t QUESTION_BANK_VERSION = 1;
+const size_t MAX_BANK_TEXT_LENGTH = 0xFFFF;  // Longest question or option text, in bytes
+
+// 32-bit FNV-1a hash used as the bank checksum; pass a previous result as hash to continue it
+inline uint32_t fnv1a(const char* data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// --- MappedFile Class ---
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#endif
+    }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            close();
+            return false;
+        }
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!data) {
+            close();
+            return false;
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+        data = static_cast<const char*>(view);
+        size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// --- QuestionBankLoader Class ---
+// Streams a text question bank into a binary bank image, validating it in a single pass.
+// One entry per line, lines starting with '#' are comments:
+//   [Level name]     starts a level ("\n" in any text becomes a line break)
+//   ? Question text  starts a question in the current level
+//   * Option text    the correct option, exactly one per question
+//   - Option text    a wrong option, 2 to MAX_OPTIONS options per question
+class QuestionBankLoader {
+public:
+    QuestionBankLoader() : lineNumber(0), questionLine(0), correctCount(0) {}
+
+    // Parse the file and write the finished bank into image
+    bool load(const std::string& path, std::vector<char>& image) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error opening question bank: " << path << std::endl;
+            return false;
+        }
+        return parse(file, path, image);
+    }
+
+    // Parse text from any stream; name is used in error messages
+    bool parse(std::istream& file, const std::string& name, std::vector<char>& image) {
+        bankPath = name;
+        lineNumber = 0;
+        questionLine = 0;
+        levels.clear();
+        questions.clear();
+        pool.clear();
+
+        std::string line;
+        bool ok = true;
+        while (ok && std::getline(file, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            // Text runs from after the marker and its spaces to the last non-space character
+            size_t begin = 1;
+            size_t end = line.size();
+            while (begin < end && (line[begin] == ' ' || line[begin] == '\t')) begin++;
+            while (end > begin && (line[end - 1] == ' ' || line[end - 1] == '\t')) end--;
+
+            switch (line[0]) {
+            case '[':
+                if (end <= begin || line[end - 1] != ']') {
+                    ok = fail(lineNumber, "level name must be written as [Name]");
+                    break;
+                }
+                ok = finishLevel();
+                if (ok) {
+                    Level level;
+                    level.nameOffset = static_cast<uint32_t>(pool.size());
+                    level.nameLength = static_cast<uint32_t>(appendText(line, begin, end - 1));
+                    level.firstQuestion = static_cast<uint32_t>(questions.size());
+                    level.questionCount = 0;
+                    levels.push_back(level);
+                }
+                break;
+            case '?':
+                if (levels.empty()) {
+                    ok = fail(lineNumber, "question outside of a level");
+                    break;
+                }
+                ok = finishQuestion();
+                if (ok) {
+                    Question q = {};
+                    q.textOffset = static_cast<uint32_t>(pool.size());
+                    q.textLength = static_cast<uint16_t>(appendText(line, begin, end));
+                    questions.push_back(q);
+                    levels.back().questionCount++;
+                    questionLine = lineNumber;
+                    correctCount = 0;
+                }
+                break;
+            case '*':
+            case '-':
+                if (levels.empty() || levels.back().questionCount == 0) {
+                    ok = fail(lineNumber, "option outside of a question");
+                    break;
+                }
+                {
+                    Question& q = questions.back();
+                    if (q.optionCount >= MAX_OPTIONS) {
+                        ok = fail(lineNumber, "too many options");
+                        break;
+                    }
+                    if (line[0] == '*') {
+                        q.correctOptionIndex = static_cast<int8_t>(q.optionCount);
+                        correctCount++;
+                    }
+                    q.optionLength[q.optionCount++] = static_cast<uint16_t>(appendText(line, begin, end));
+                }
+                break;
+            default:
+                ok = fail(lineNumber, "unknown entry");
+                break;
+            }
+            if (ok && end - begin > MAX_BANK_TEXT_LENGTH)
+                ok = fail(lineNumber, "text too long");
+        }
+
+        if (ok)
+            ok = finishLevel();
+        if (ok && levels.empty())
+            ok = fail(lineNumber, "no levels found");
+        if (ok)
+            writeImage(image);
+        return ok;
+    }
+
+private:
+    std::string bankPath;
+    int lineNumber;
+    int questionLine;
+    int correctCount;
+    std::vector<Level> levels;
+    std::vector<Question> questions;
+    std::string pool;
+
+    bool fail(int line, const char* message) const {
+        std::cerr << "Error in question bank " << bankPath << " line " << line << ": " << message << std::endl;
+        return false;
+    }
+
+    // Append line[begin, end) to the pool, turning "\n" escapes into line breaks; returns the length added
+    size_t appendText(const std::string& line, size_t begin, size_t end) {
+        size_t start = pool.size();
+        const char* text = line.data();
+        while (begin < end) {
+            const char* slash = static_cast<const char*>(std::memchr(text + begin, '\\', end - begin));
+            size_t stop = slash ? static_cast<size_t>(slash - text) : end;
+            pool.append(text + begin, stop - begin);
+            begin = stop;
+            if (slash) {
+                bool escape = begin + 1 < end && text[begin + 1] == 'n';
+                pool += escape ? '\n' : '\\';
+                begin += escape ? 2 : 1;
+            }
+        }
+        return pool.size() - start;
+    }
+
+    // Check the question being built before starting another one
+    bool finishQuestion() const {
+        if (levels.empty() || levels.back().questionCount == 0)
+            return true;
+        const Question& q = questions.back();
+        if (q.textLength == 0)
+            return fail(questionLine, "empty question text");
+        if (q.optionCount < 2)
+            return fail(questionLine, "question needs at least 2 options");
+        if (correctCount != 1)
+            return fail(questionLine, "question needs exactly one correct (*) option");
+        return true;
+    }
+
+    bool finishLevel() const {
+        if (levels.empty())
+            return true;
+        if (levels.back().questionCount == 0)
+            return fail(lineNumber, "previous level has no questions");
+        return finishQuestion();
+    }
+
+    void writeImage(std::vector<char>& image) const {
+        QuestionBankHeader header;
+        std::copy(QUESTION_BANK_MAGIC, QUESTION_BANK_MAGIC + 4, header.magic);
+        header.version = QUESTION_BANK_VERSION;
+        header.levelCount = static_cast<uint32_t>(levels.size());
+        header.questionCount = static_cast<uint32_t>(questions.size());
+        header.poolSize = static_cast<uint32_t>(pool.size());
+
+        size_t levelBytes = levels.size() * sizeof(Level);
+        size_t questionBytes = questions.size() * sizeof(Question);
+        image.resize(sizeof(header) + levelBytes + questionBytes + pool.size());
+        char* out = image.data() + sizeof(header);
+        if (levelBytes) std::memcpy(out, levels.data(), levelBytes);
+        if (questionBytes) std::memcpy(out + levelBytes, questions.data(), questionBytes);
+        if (!pool.empty()) std::memcpy(out + levelBytes + questionBytes, pool.data(), pool.size());
+
+        header.checksum = fnv1a(out, image.size() - sizeof(header));
+        std::memcpy(image.data(), &header, sizeof(header));
+    }
+};
+
+// --- QuestionBank Class ---
+// Read-only question bank backed by one contiguous image: either a memory-mapped
+// binary bank file or an image compiled in memory from the text format. Levels and
+// questions are read in place; text is returned as views into the string pool.
+class QuestionBank {
+public:
+    QuestionBank()
+        : imageData(nullptr), imageSize(0), levels(nullptr), questions(nullptr), pool(nullptr),
+        levelTotal(0), questionTotal(0), poolSize(0) {
+    }
+
+    QuestionBank(const QuestionBank&) = delete;
+    QuestionBank& operator=(const QuestionBank&) = delete;
+
+    // Load a binary bank if the file starts with the bank magic, otherwise parse it as text
+    bool load(const std::string& path) {
+        char magic[4] = {};
+        std::ifstream file(path, std::ios::binary);
+        if (file.read(magic, 4) && std::equal(magic, magic + 4, QUESTION_BANK_MAGIC)) {
+            file.close();
+            return loadBinary(path);
+        }
+        file.close();
+        return loadText(path);
+    }
+
+    bool loadText(const std::string& path) {
+        clear();
+        QuestionBankLoader loader;
+        if (!loader.load(path, image))
+            return false;
+        return attach(image.data(), image.size(), path, false);
+    }
+
+    // Parse a text bank from a stream, e.g. one generated in memory
+    bool loadText(std::istream& text, const std::string& name) {
+        clear();
+        QuestionBankLoader loader;
+        if (!loader.parse(text, name, image))
+            return false;
+        return attach(image.data(), image.size(), name, false);
+    }
+
+    bool loadBinary(const std::string& path) {
+        clear();
+        if (!mapped.open(path)) {
+            std::cerr << "Error mapping question bank: " << path << std::endl;
+            return false;
+        }
+        return attach(mapped.getData(), mapped.getSize(), path, true);
+    }
+
+    // Write the bank image so it can be memory-mapped later
+    bool save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(imageData, static_cast<std::streamsize>(imageSize))) {
+            std::cerr << "Error writing question bank: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        mapped.close();
+        image.clear();
+        levels = nullptr;
+        questions = nullptr;
+        pool = nullptr;
+        imageData = nullptr;
+        imageSize = 0;
+        levelTotal = questionTotal = poolSize = 0;
+    }
+
+    size_t levelCount() const { return levelTotal; }
+    size_t questionCount() const { return questionTotal; }
+    size_t byteSize() const { return imageSize; }
+    uint32_t checksum() const { return imageData ? reinterpret_cast<const QuestionBankHeader*>(imageData)->checksum : 0; }
+
+    const Level& level(size_t levelIdx) const { return levels[levelIdx]; }
+    const Question& question(size_t levelIdx, size_t questionIdx) const {
+        return questions[levels[levelIdx].firstQuestion + questionIdx];
+    }
+
+    TextView levelName(const Level& l) const {
+        TextView view = { pool + l.nameOffset, l.nameLength };
+        return view;
+    }
+
+    TextView questionText(const Question& q) const {
+        TextView view = { pool + q.textOffset, q.textLength };
+        return view;
+    }
+
+    // The whole string pool: every level name, question and option
+    TextView allText() const {
+        TextView view = { pool, poolSize };
+        return view;
+    }
+
+    TextView optionText(const Question& q, int optionIdx) const {
+        size_t offset = q.textOffset + q.textLength;
+        for (int i = 0; i < optionIdx; ++i)
+            offset += q.optionLength[i];
+        TextView view = { pool + offset, q.optionLength[optionIdx] };
+        return view;
+    }
+
+private:
+    MappedFile mapped;
+    std::vector<char> image;
+    const char* imageData;
+    size_t imageSize;
+    const Level* levels;
+    const Question* questions;
+    const char* pool;
+    size_t levelTotal;
+    size_t questionTotal;
+    size_t poolSize;
+
+    bool fail(const std::string& path, const char* message) {
+        std::cerr << "Error in question bank " << path << ": " << message << std::endl;
+        clear();
+        return false;
+    }
+
+    bool validText(size_t offset, size_t length) const {
+        return offset <= poolSize && length <= poolSize - offset;
+    }
+
+    // Check the header, checksum and every record so later lookups need no bounds checks.
+    // Images compiled in memory skip the checksum since they never left this process.
+    bool attach(const char* data, size_t size, const std::string& path, bool verifyChecksum) {
+        if (size < sizeof(QuestionBankHeader))
+            return fail(path, "file too small");
+        QuestionBankHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (!std::equal(header.magic, header.magic + 4, QUESTION_BANK_MAGIC))
+            return fail(path, "not a binary question bank");
+        if (header.version != QUESTION_BANK_VERSION)
+            return fail(path, "unsupported bank version");
+
+        uint64_t expected = sizeof(header) + uint64_t(header.levelCount) * sizeof(Level)
+            + uint64_t(header.questionCount) * sizeof(Question) + header.poolSize;
+        if (expected != size)
+            return fail(path, "size does not match header");
+        if (verifyChecksum && fnv1a(data + sizeof(header), size - sizeof(header)) != header.checksum)
+            return fail(path, "checksum mismatch");
+
+        imageData = data;
+        imageSize = size;
+        levels = reinterpret_cast<const Level*>(data + sizeof(header));
+        questions = reinterpret_cast<const Question*>(levels + header.levelCount);
+        pool = reinterpret_cast<const char*>(questions + header.questionCount);
+        levelTotal = header.levelCount;
+        questionTotal = header.questionCount;
+        poolSize = header.poolSize;
+
+        // Levels must tile the questions in order; the scheduler heaps, difficulty
+        // buckets and journal replay index per-level segments by firstQuestion
+        size_t runningTotal = 0;
+        for (size_t i = 0; i < levelTotal; ++i) {
+            const Level& l = levels[i];
+            if (!validText(l.nameOffset, l.nameLength) || l.questionCount == 0 || l.firstQuestion != runningTotal
+                || l.questionCount > questionTotal - runningTotal)
+                return fail(path, "corrupt level record");
+            runningTotal += l.questionCount;
+        }
+        if (runningTotal != questionTotal)
+            return fail(path, "levels do not cover every question");
+        for (size_t i = 0; i < questionTotal; ++i) {
+            const Question& q = questions[i];
+            size_t textLength = q.textLength;
+            for (int o = 0; o < MAX_OPTIONS; ++o)
+                textLength += q.optionLength[o];
+            if (!validText(q.textOffset, textLength) || q.optionCount < 2 || q.optionCount > MAX_OPTIONS
+                || q.correctOptionIndex < 0 || q.correctOptionIndex >= q.optionCount)
+                return fail(path, "corrupt question record");
+        }
+        return true;
+    }
+};
+
+// --- QuestionScheduler Class ---
+// SM-2 style spaced repetition over the question bank. Each question has an ease
+// factor, an interval and a due time, kept in parallel arrays indexed by the
+// question's position in the bank. Time is counted in answers (the review clock),
+// so scheduling is the same windowed, headless and in a replay. Each level's
+// questions form an indexed min-heap ordered by due time, stored in the segment
+// of one array the level owns, so the next question is the heap top and
+// rescheduling an answered one is O(log n).
+//
+// Questions not seen yet are never due, so the heap top is the most overdue
+// review; GameLogic asks that first when its due time has come and otherwise lets
+// the DifficultyModel pick. Wrong answers come back soon and well-known questions
+// move further back.
+//
+// SaveGame stores only the questions that were answered; heaps are rebuilt on load.
+const uint32_t SCHEDULE_UNSEEN = 0xFFFFFFFFu;  // Due time of a question never answered
+const uint16_t SM2_INITIAL_EASE = 2500;      // Ease factor 2.5, in thousandths
+const uint16_t SM2_MIN_EASE = 1300;
+const uint32_t SM2_MAX_INTERVAL = 1u << 24;  // Longest interval, in answers
+
+class QuestionScheduler {
+public:
+    // State of one question, as saved by SaveGame
+    struct Entry {
+        uint32_t due;
+        uint32_t interval;
+        uint16_t ease;
+        uint8_t repetitions;
+    };
+
+    QuestionScheduler() : clock(0) {}
+
+    // Start a fresh schedule for every question in bank
+    void reset(const QuestionBank& bank) {
+        const size_t n = bank.questionCount();
+        clock = 0;
+        due.assign(n, SCHEDULE_UNSEEN);
+        interval.assign(n, 0);
+        ease.assign(n, SM2_INITIAL_EASE);
+        repetitions.assign(n, 0);
+        heap.resize(n);
+        heapPos.resize(n);
+        for (size_t i = 0; i < n; ++i) { // all unseen, so index order is already a valid heap
+            heap[i] = static_cast<uint32_t>(i);
+            heapPos[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Index within the level of the most overdue review whose id is not in exclude, or -1
+    // if there is none. Only due entries and their children are visited: below an
+    // entry that isn't excluded everything comes later, so the walk stops there.
+    int nextDue(const Level& level, const std::vector<uint32_t>& exclude) {
+        if (level.questionCount == 0 || level.firstQuestion >= heap.size())
+            return -1;
+        int best = -1;
+        frontier.clear();
+        frontier.push_back(0);
+        while (!frontier.empty()) {
+            uint32_t slot = frontier.back();
+            frontier.pop_back();
+            uint32_t id = heap[level.firstQuestion + slot];
+            if (due[id] > clock)
+                continue;
+            if (std::find(exclude.begin(), exclude.end(), id) == exclude.end()) {
+                if (best < 0 || before(id, level.firstQuestion + best))
+                    best = static_cast<int>(id - level.firstQuestion);
+                continue;
+            }
+            for (uint32_t child = 2 * slot + 1; child <= 2 * slot + 2 && child < level.questionCount; ++child)
+                frontier.push_back(child);
+        }
+        return best;
+    }
+
+    // Record an answer (SM-2 with quality 4 for correct, 1 for wrong) and reschedule the question
+    void review(const Level& level, size_t questionIdx, bool correct) {
+        uint32_t id = level.firstQuestion + static_cast<uint32_t>(questionIdx);
+        if (id >= due.size()) return;
+        ++clock;
+        if (correct) {
+            if (repetitions[id] == 0) interval[id] = 1;
+            else if (repetitions[id] == 1) interval[id] = 6;
+            else interval[id] = std::min<uint32_t>(SM2_MAX_INTERVAL, (interval[id] * ease[id] + 500) / 1000);
+            if (repetitions[id] < 255) ++repetitions[id];
+        }
+        else {
+            repetitions[id] = 0;
+            interval[id] = 1;
+        }
+        // EF' = EF + 0.1 - (5 - q) * (0.08 + (5 - q) * 0.02), in thousandths
+        int q = correct ? 4 : 1;
+        int newEase = ease[id] + 100 - (5 - q) * (80 + (5 - q) * 20);
+        ease[id] = static_cast<uint16_t>(std::max<int>(SM2_MIN_EASE, newEase));
+
+        uint32_t oldDue = due[id];
+        due[id] = clock + interval[id];
+        if (due[id] < oldDue) siftUp(level, heapPos[id] - level.firstQuestion);
+        else siftDown(level, heapPos[id] - level.firstQuestion);
+    }
+
+    uint32_t reviewClock() const { return clock; }
+    size_t size() const { return due.size(); }
+    bool answered(uint32_t id) const { return due[id] != SCHEDULE_UNSEEN; }
+    Entry entry(uint32_t id) const {
+        Entry e = { due[id], interval[id], ease[id], repetitions[id] };
+        return e;
+    }
+
+    // Restore saved entries over a fresh schedule, then call rebuild()
+    void restore(uint32_t id, const Entry& e) {
+        due[id] = e.due;
+        interval[id] = e.interval;
+        ease[id] = std::max(SM2_MIN_EASE, e.ease);
+        repetitions[id] = e.repetitions;
+    }
+
+    void rebuild(const QuestionBank& bank, uint32_t clock_) {
+        clock = clock_;
+        for (size_t l = 0; l < bank.levelCount(); ++l)
+            heapify(bank.level(l));
+    }
+
+private:
+    uint32_t clock;
+    std::vector<uint32_t> due;
+    std::vector<uint32_t> interval;
+    std::vector<uint16_t> ease;
+    std::vector<uint8_t> repetitions;
+    std::vector<uint32_t> heap;    // question ids; level l's heap is heap[firstQuestion, firstQuestion + questionCount)
+    std::vector<uint32_t> heapPos; // where each question id sits in heap
+    std::vector<uint32_t> frontier; // heap slots still to visit in nextDue()
+
+    bool before(uint32_t a, uint32_t b) const {
+        return due[a] < due[b] || (due[a] == due[b] && a < b);
+    }
+
+    void place(const Level& level, uint32_t slot, uint32_t id) {
+        heap[level.firstQuestion + slot] = id;
+        heapPos[id] = level.firstQuestion + slot;
+    }
+
+    void siftUp(const Level& level, uint32_t slot) {
+        uint32_t id = heap[level.firstQuestion + slot];
+        while (slot > 0) {
+            uint32_t parent = (slot - 1) / 2;
+            uint32_t parentId = heap[level.firstQuestion + parent];
+            if (!before(id, parentId)) break;
+            place(level, slot, parentId);
+            slot = parent;
+        }
+        place(level, slot, id);
+    }
+
+    void siftDown(const Level& level, uint32_t slot) {
+        const uint32_t n = level.questionCount;
+        uint32_t id = heap[level.firstQuestion + slot];
+        for (;;) {
+            uint32_t child = 2 * slot + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(heap[level.firstQuestion + child + 1], heap[level.firstQuestion + child]))
+                ++child;
+            uint32_t childId = heap[level.firstQuestion + child];
+            if (!before(childId, id)) break;
+            place(level, slot, childId);
+            slot = child;
+        }
+        place(level, slot, id);
+    }
+
+    void heapify(const Level& level) {
+        for (uint32_t slot = level.questionCount / 2; slot-- > 0;)
+            siftDown(level, slot);
+    }
+};
+
+// --- DifficultyModel Class ---
+// Elo-style ratings for the player and for every question, updated in O(1) after
+// each answer: the expected score is 1 / (1 + 10^((question - player) / 400)),
+// and both ratings move by K times the surprise. Quick correct answers score 1,
+// slow ones score less, and wrong ones score 0.
+//
+// For selection, each level's questions are kept in one segment of an array,
+// partitioned into DIFFICULTY_BUCKETS rating buckets with start offsets per bucket.
+// When a rating crosses a bucket boundary, the question is swapped across the
+// boundary, which costs at most one swap per bucket crossed. The next question comes
+// from the bucket nearest the rating at which the player succeeds TARGET_SUCCESS of
+// the time, so picking one doesn't scan the level.
+//
+// SaveGame stores the player rating and the ratings of answered questions; the
+// bucket index is rebuilt on load.
+const float INITIAL_RATING = 1500.f;
+const float RATING_FLOOR = 700.f;             // Question ratings are clamped to the bucketed range
+const float RATING_CEILING = 2300.f;
+const int DIFFICULTY_BUCKETS = 32;
+const float DIFFICULTY_BUCKET_WIDTH = (RATING_CEILING - RATING_FLOOR) / DIFFICULTY_BUCKETS;
+const float PLAYER_K = 32.f;                  // Rating change for a fully surprising answer
+const float QUESTION_K = 16.f;
+const float TARGET_SUCCESS = 0.7f;            // Chance of a correct answer the next question aims for
+const float FAST_ANSWER_SECONDS = 5.f;        // Correct answers up to this quick score 1
+const float SLOW_ANSWER_SECONDS = 20.f;       // and from this slow score 1 - SLOW_ANSWER_PENALTY
+const float SLOW_ANSWER_PENALTY = 0.4f;
+const int ADAPTIVE_MIN_QUESTIONS = 5;         // A level run asks at least this many questions (if the level has them)
+const int ADAPTIVE_MAX_QUESTIONS = 12;        // and at most this many
+const float ADAPTIVE_SETTLED_CHANGE = 8.f;    // Between the two, it ends once an answer moves the player's rating less than this
+
+class DifficultyModel {
+public:
+    float playerRating;
+
+    DifficultyModel() : playerRating(INITIAL_RATING) {}
+
+    // Rate each level's questions from 200 below to 200 above the start rating in bank
+    // order, since banks list easy questions first; the player starts at INITIAL_RATING
+    void reset(const QuestionBank& bank) {
+        playerRating = INITIAL_RATING;
+        ratings.resize(bank.questionCount());
+        for (size_t l = 0; l < bank.levelCount(); ++l) {
+            const Level& level = bank.level(l);
+            for (uint32_t i = 0; i < level.questionCount; ++i) {
+                float t = level.questionCount > 1 ? float(i) / float(level.questionCount - 1) : 0.5f;
+                ratings[level.firstQuestion + i] = INITIAL_RATING - 200.f + 400.f * t;
+            }
+        }
+        buildIndex(bank);
+    }
+
+    // Probability the player answers question id correctly
+    float expectedScore(uint32_t id) const {
+        return 1.f / (1.f + std::pow(10.f, (ratings[id] - playerRating) / 400.f));
+    }
+
+    // Update both ratings after an answer given after seconds; returns how far the
+    // player's rating moved
+    float update(size_t levelIdx, uint32_t id, bool correct, float seconds) {
+        if (id >= ratings.size()) return 0.f;
+        float score = 0.f;
+        if (correct) {
+            float slowness = (seconds - FAST_ANSWER_SECONDS) / (SLOW_ANSWER_SECONDS - FAST_ANSWER_SECONDS);
+            score = 1.f - SLOW_ANSWER_PENALTY * std::max(0.f, std::min(1.f, slowness));
+        }
+        float surprise = score - expectedScore(id);
+        playerRating += PLAYER_K * surprise;
+        ratings[id] = std::max(RATING_FLOOR, std::min(RATING_CEILING, ratings[id] - QUESTION_K * surprise));
+        moveToBucket(levelIdx, id, bucketOf(ratings[id]));
+        return std::fabs(PLAYER_K * surprise);
+    }
+
+    // Index within the level of a question near the player's target difficulty, not in
+    // exclude (questions already asked this run), chosen at random within its bucket;
+    // -1 if every question is excluded
+    int pick(const QuestionBank& bank, size_t levelIdx, const std::vector<uint32_t>& exclude, std::mt19937& rng) const {
+        const Level& level = bank.level(levelIdx);
+        if (level.questionCount == 0 || levelIdx * (DIFFICULTY_BUCKETS + 1) >= bucketStart.size())
+            return -1;
+        const float targetRating = playerRating + 400.f * std::log10(1.f / TARGET_SUCCESS - 1.f);
+        const int target = bucketOf(targetRating);
+        const uint32_t* start = &bucketStart[levelIdx * (DIFFICULTY_BUCKETS + 1)];
+        for (int distance = 0; distance < DIFFICULTY_BUCKETS; ++distance) {
+            for (int side = 0; side < 2; ++side) {
+                int bucket = side == 0 ? target - distance : target + distance;
+                if (bucket < 0 || bucket >= DIFFICULTY_BUCKETS || (side == 1 && distance == 0)) continue;
+                uint32_t begin = start[bucket], size = start[bucket + 1] - begin;
+                if (size == 0) continue;
+                uint32_t offset = std::uniform_int_distribution<uint32_t>(0, size - 1)(rng);
+                for (uint32_t k = 0; k < size; ++k) {
+                    uint32_t id = order[begin + (offset + k) % size];
+                    if (std::find(exclude.begin(), exclude.end(), id) == exclude.end())
+                        return static_cast<int>(id - level.firstQuestion);
+                }
+            }
+        }
+        return -1;
+    }
+
+    float rating(uint32_t id) const { return ratings[id]; }
+
+    // Restore saved ratings over fresh ones, then call rebuild()
+    void restore(uint32_t id, float rating_) {
+        ratings[id] = std::max(RATING_FLOOR, std::min(RATING_CEILING, rating_));
+    }
+
+    void rebuild(const QuestionBank& bank) { buildIndex(bank); }
+
+private:
+    std::vector<float> ratings;        // by question id
+    std::vector<uint32_t> order;       // question ids; each level's segment is partitioned by bucket
+    std::vector<uint32_t> position;    // where each question id sits in order
+    std::vector<uint32_t> bucketStart; // DIFFICULTY_BUCKETS + 1 offsets into order per level
+
+    static int bucketOf(float rating) {
+        int bucket = static_cast<int>((rating - RATING_FLOOR) / DIFFICULTY_BUCKET_WIDTH);
+        return std::max(0, std::min(DIFFICULTY_BUCKETS - 1, bucket));
+    }
+
+    // Counting sort of every level's questions into its buckets
+    void buildIndex(const QuestionBank& bank) {
+        order.resize(ratings.size());
+        position.resize(ratings.size());
+        bucketStart.assign(bank.levelCount() * (DIFFICULTY_BUCKETS + 1), 0);
+        for (size_t l = 0; l < bank.levelCount(); ++l) {
+            const Level& level = bank.level(l);
+            uint32_t* start = &bucketStart[l * (DIFFICULTY_BUCKETS + 1)];
+            uint32_t counts[DIFFICULTY_BUCKETS] = {};
+            for (uint32_t i = 0; i < level.questionCount; ++i)
+                counts[bucketOf(ratings[level.firstQuestion + i])]++;
+            start[0] = level.firstQuestion;
+            for (int b = 0; b < DIFFICULTY_BUCKETS; ++b)
+                start[b + 1] = start[b] + counts[b];
+            uint32_t fill[DIFFICULTY_BUCKETS];
+            std::copy(start, start + DIFFICULTY_BUCKETS, fill);
+            for (uint32_t i = 0; i < level.questionCount; ++i) {
+                uint32_t id = level.firstQuestion + i;
+                uint32_t slot = fill[bucketOf(ratings[id])]++;
+                order[slot] = id;
+                position[id] = slot;
+            }
+        }
+    }
+
+    void swapSlots(uint32_t a, uint32_t b) {
+        std::swap(order[a], order[b]);
+        position[order[a]] = a;
+        position[order[b]] = b;
+    }
+
+    // Walk id across the bucket boundaries between its current bucket and bucket
+    void moveToBucket(size_t levelIdx, uint32_t id, int bucket) {
+        uint32_t* start = &bucketStart[levelIdx * (DIFFICULTY_BUCKETS + 1)];
+        int current = 0;
+        while (current < DIFFICULTY_BUCKETS - 1 && position[id] >= start[current + 1])
+            ++current;
+        while (current < bucket) { // becomes the first entry of the next bucket
+            swapSlots(position[id], start[current + 1] - 1);
+            --start[current + 1];
+            ++current;
+        }
+        while (current > bucket) { // becomes the last entry of the previous bucket
+            swapSlots(position[id], start[current]);
+            ++start[current];
+            --current;
+        }
+    }
+};
+
+// --- VoicePool Class ---
+// Fixed set of sf::Sound voices shared by all sound effects. Every voice (and its
+// OpenAL source) is created up front, so playing a sound never creates one mid-frame.
+// When all voices are busy the new sound steals the oldest voice of the lowest
+// priority not above its own, or is dropped if every voice outranks it. Buffers are
+// owned by the AssetManager and shared between voices; a free voice that already
+// holds the requested buffer is preferred so it doesn't have to be re-attached.
+class VoicePool {
+public:
+    enum Category { SOUND_EFFECTS, SOUND_FEEDBACK, CATEGORY_COUNT };
+    enum Priority { PRIORITY_LOW, PRIORITY_NORMAL, PRIORITY_HIGH };
+
+    explicit VoicePool(size_t voiceCount = MAX_VOICES)
+        : voices(voiceCount), playCounter(0) {
+        for (int i = 0; i < CATEGORY_COUNT; ++i)
+            categoryVolume[i] = 1.f;
+    }
+
+    VoicePool(const VoicePool&) = delete;
+    VoicePool& operator=(const VoicePool&) = delete;
+
+    // Start a sound; returns the voice used, or -1 if it was dropped
+    int play(const sf::SoundBuffer& buffer, Category category, Priority priority, float pitch = 1.f) {
+        if (buffer.getSampleCount() == 0) return -1; // not loaded (yet)
+
+        int chosen = -1;
+        for (size_t i = 0; i < voices.size(); ++i) {
+            if (voices[i].sound.getStatus() != sf::Sound::Stopped) continue;
+            if (chosen < 0 || voices[i].sound.getBuffer() == &buffer) chosen = static_cast<int>(i);
+            if (voices[i].sound.getBuffer() == &buffer) break;
+        }
+        if (chosen < 0) {
+            for (size_t i = 0; i < voices.size(); ++i) {
+                const Voice& v = voices[i];
+                if (v.priority > priority) continue;
+                if (chosen < 0 || v.priority < voices[chosen].priority
+                    || (v.priority == voices[chosen].priority && v.started < voices[chosen].started))
+                    chosen = static_cast<int>(i);
+            }
+            if (chosen < 0) return -1;
+            voices[chosen].sound.stop();
+        }
+
+        Voice& voice = voices[chosen];
+        if (voice.sound.getBuffer() != &buffer)
+            voice.sound.setBuffer(buffer);
+        voice.category = category;
+        voice.priority = priority;
+        voice.started = ++playCounter;
+        voice.sound.setPitch(pitch);
+        voice.sound.setVolume(volumeFor(category));
+        voice.sound.play();
+        return chosen;
+    }
+
+    // Volumes are 0..1 and apply to playing voices at once
+    void setCategoryVolume(Category category, float volume) {
+        categoryVolume[category] = volume;
+        for (auto& voice : voices)
+            voice.sound.setVolume(volumeFor(voice.category));
+    }
+
+    void stopAll() {
+        for (auto& voice : voices) voice.sound.stop();
+    }
+
+private:
+    struct Voice {
+        sf::Sound sound;
+        Category category = SOUND_EFFECTS;
+        Priority priority = PRIORITY_LOW;
+        uint64_t started = 0; // play order, for stealing the oldest voice
+    };
+
+    std::vector<Voice> voices;
+    float categoryVolume[CATEGORY_COUNT];
+    uint64_t playCounter;
+
+    float volumeFor(Category category) const {
+        return 100.f * categoryVolume[category];
+    }
+};
+
+// --- Explosion Class ---
+// Handles animated explosion sprite for incorrect answers
+class Explosion {
+public:
+    sf::Sprite sprite;
+    sf::IntRect sheetRect;
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int numFrames = 0;
+    int currentFrame = 0;
+    float frameDuration = 0.05f;
+    float timer = 0.f;
+    bool isPlaying = false;
+
+    Explosion() : currentFrame(0), timer(0.f), isPlaying(false) {}
+
+    // Use an explosion spritesheet from the sprite atlas and calculate frames
+    void setSpriteSheet(const TextureAtlas::Region& region, int frames) {
+        sheetRect = region.rect;
+        numFrames = frames;
+        frameWidth = sheetRect.width / numFrames;
+        frameHeight = sheetRect.height;
+        sprite.setTexture(*region.texture);
+        sprite.setTextureRect(frameRect(0));
+        sprite.setOrigin(frameWidth / 2.f, frameHeight / 2.f);
+    }
+
+    // Texture rect of one animation frame inside the atlas
+    sf::IntRect frameRect(int frame) const {
+        return sf::IntRect(sheetRect.left + frame * frameWidth, sheetRect.top, frameWidth, frameHeight);
+    }
+
+    // Start animation at given position
+    void start(sf::Vector2f position) {
+        if (frameWidth <= 0) return;
+        sprite.setPosition(position);
+        currentFrame = 0;
+        isPlaying = true;
+        timer = 0.f;
+        sprite.setTextureRect(frameRect(0));
+    }
+
+    // Advance animation frames by dt seconds of simulation time
+    void update(float dt) {
+        if (!isPlaying) return;
+
+        timer += dt;
+
+        while (timer >= frameDuration && isPlaying) {
+            timer -= frameDuration;
+            currentFrame++;
+            if (currentFrame >= numFrames) {
+                isPlaying = false;
+                currentFrame = 0;
+                sprite.setTextureRect(frameRect(0));
+            }
+            else {
+                sprite.setTextureRect(frameRect(currentFrame));
+            }
+        }
+    }
+
+    // Queue the explosion if playing
+    void draw(SpriteBatch& batch) const {
+        if (isPlaying)
+            batch.add(sprite);
+    }
+};
+
+// --- GameLogic Class ---
+// Game state machine, scoring, level unlocking and question selection. It has no
+// window, font or audio dependency, so the windowed Game and the headless simulator
+// share it. A level run asks due spaced-repetition reviews first and otherwise the
+// question the difficulty model picks for the player's rating. The run ends once the
+// rating has settled, between ADAPTIVE_MIN_QUESTIONS and ADAPTIVE_MAX_QUESTIONS answers.
+class GameLogic {
+public:
+    // Enumeration of game states
+    enum GameState { MENU, LEVEL_SELECTION, RULES, IN_GAME, GAME_OVER };
+
+    // Outcome of answering the current question
+    enum AnswerResult { ANSWER_INVALID, ANSWER_CORRECT, ANSWER_INCORRECT, ANSWER_GAME_OVER };
+
+    // What happened when the feedback delay ran out
+    enum FeedbackResult { FEEDBACK_PENDING, FEEDBACK_NEXT_QUESTION, FEEDBACK_LEVEL_COMPLETE, FEEDBACK_RETURN_TO_MENU };
+
+    GameState gameState;
+    QuestionBank bank;
+    QuestionScheduler scheduler;
+    DifficultyModel difficulty;
+    std::mt19937 rng; // all gameplay randomness, seeded by the session so replays match
+    std::vector<bool> levelUnlocked;
+    std::vector<uint32_t> bestScore; // per level, over finished runs
+    int currentLevel;
+    int currentQuestionIndex;
+    int questionsAsked;              // answered so far in this level run
+    std::vector<uint32_t> askedThisRun; // their question ids
+    uint32_t questionSteps;          // fixed steps the current question has been up
+    float lastRatingChange;
+    int score;
+    int lives;
+    bool showingFeedback;
+    float feedbackElapsed;
+
+    GameLogic()
+        : gameState(MENU), currentLevel(0), currentQuestionIndex(0), questionsAsked(0), questionSteps(0),
+        lastRatingChange(0.f), score(0), lives(3), showingFeedback(false), feedbackElapsed(0.f) {
+        askedThisRun.reserve(ADAPTIVE_MAX_QUESTIONS);
+    }
+
+    void seed(unsigned value) { rng.seed(value); }
+
+    // Load levels from the question bank file and lock all but the first
+    bool loadLevels(const std::string& questionBankPath) {
+        bool ok = bank.load(questionBankPath);
+        resetProgress();
+        return ok;
+    }
+
+    // Lock every level but the first, start a fresh schedule and ratings and go back to the menu
+    void resetProgress() {
+        scheduler.reset(bank);
+        difficulty.reset(bank);
+        levelUnlocked.assign(bank.levelCount(), false);
+        if (!levelUnlocked.empty())
+            levelUnlocked[0] = true;
+        bestScore.assign(bank.levelCount(), 0);
+        gameState = MENU;
+        showingFeedback = false;
+    }
+
+    void returnToMenu() { gameState = MENU; }
+    void openLevelSelection() { gameState = LEVEL_SELECTION; }
+    void openRules() { gameState = RULES; }
+
+    bool isLevelUnlocked(int levelIdx) const {
+        return levelIdx >= 0 && static_cast<size_t>(levelIdx) < levelUnlocked.size() && levelUnlocked[levelIdx];
+    }
+
+    // Start a fresh run of an unlocked level
+    bool startLevel(int levelIdx) {
+        if (!isLevelUnlocked(levelIdx))
+            return false;
+        currentLevel = levelIdx;
+        questionsAsked = 0;
+        askedThisRun.clear();
+        currentQuestionIndex = pickQuestion();
+        questionSteps = 0;
+        score = 0;
+        lives = 3;
+        gameState = IN_GAME;
+        return true;
+    }
+
+    // Validate level/question indices; falls back to level selection when out of range
+    const Question* loadQuestion(int levelIdx, int questionIdx) {
+        if ((unsigned)levelIdx >= bank.levelCount() || (unsigned)questionIdx >= bank.level(levelIdx).questionCount) {
+            gameState = LEVEL_SELECTION;
+            return nullptr;
+        }
+        showingFeedback = false;
+        questionSteps = 0;
+        return &bank.question(levelIdx, questionIdx);
+    }
+
+    // Upper bound of the current level run's length
+    int runLength() const {
+        if (static_cast<size_t>(currentLevel) >= bank.levelCount()) return 0;
+        return std::min<int>(ADAPTIVE_MAX_QUESTIONS, bank.level(currentLevel).questionCount);
+    }
+
+    // The run ends at runLength(), or earlier once the minimum is asked and the rating has settled
+    bool runComplete() const {
+        int minimum = std::min(ADAPTIVE_MIN_QUESTIONS, runLength());
+        return questionsAsked >= runLength() || (questionsAsked >= minimum && lastRatingChange < ADAPTIVE_SETTLED_CHANGE);
+    }
+
+    const Question* currentQuestion() const {
+        size_t uLevel = static_cast<size_t>(currentLevel);
+        size_t uQuestion = static_cast<size_t>(currentQuestionIndex);
+        if (uLevel >= bank.levelCount() || uQuestion >= bank.level(uLevel).questionCount)
+            return nullptr;
+        return &bank.question(uLevel, uQuestion);
+    }
+
+    // Bank-wide id of the current question
+    uint32_t currentQuestionId() const {
+        return bank.level(currentLevel).firstQuestion + static_cast<uint32_t>(currentQuestionIndex);
+    }
+
+    // How long the current question has been up, in whole milliseconds
+    uint32_t questionLatencyMs() const {
+        return static_cast<uint32_t>(questionSteps * SIM_TIME_STEP * 1000.f + 0.5f);
+    }
+
+    // Apply a journaled answer to the schedule and ratings exactly as checkAnswer() did
+    bool replayAnswer(uint32_t questionId, bool correct, uint32_t latencyMs) {
+        if (questionId >= bank.questionCount())
+            return false;
+        // Levels are contiguous and in bank order; find the last one starting at or before questionId
+        size_t lo = 0, hi = bank.levelCount();
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (bank.level(mid).firstQuestion <= questionId) lo = mid; else hi = mid;
+        }
+        const Level& level = bank.level(lo);
+        if (questionId - level.firstQuestion >= level.questionCount)
+            return false;
+        review(static_cast<int>(lo), static_cast<int>(questionId - level.firstQuestion), correct, latencyMs);
+        return true;
+    }
 
-// --- Bullet Class ---
-// Represents a bullet shot by the shooter
-class Bullet {
-public:
-    sf::Sprite sprite;
-    float speed;
+    // Score the selected option and start the feedback delay
+    AnswerResult checkAnswer(int selected) {
+        const Question* question = currentQuestion();
+        if (!question)
+            return ANSWER_INVALID;
+
+        showingFeedback = true;
+        feedbackElapsed = 0.f;
+        const bool correct = selected == question->correctOptionIndex;
+        ++questionsAsked;
+        askedThisRun.push_back(currentQuestionId());
+        lastRatingChange = review(currentLevel, currentQuestionIndex, correct, questionLatencyMs());
+
+        if (selected == question->correctOptionIndex) {
+            score += 10;
+            return ANSWER_CORRECT;
+        }
+        lives--;
+        if (lives <= 0) {
+            recordScore();
+            gameState = GAME_OVER;
+            return ANSWER_GAME_OVER;
+        }
+        return ANSWER_INCORRECT;
+    }
+
+    // Count steps the window slept through while nothing could change; the question
+    // timer is the only thing that moves
+    void skipSteps(uint32_t steps) {
+        if (gameState == IN_GAME && !showingFeedback)
+            questionSteps += steps;
+    }
+
+    // Advance the feedback delay; once it runs out move to the next question or finish the level
+    FeedbackResult update(float dt) {
+        if (gameState != IN_GAME)
+            return FEEDBACK_PENDING;
+        if (!showingFeedback) {
+            ++questionSteps;
+            return FEEDBACK_PENDING;
+        }
+
+        feedbackElapsed += dt;
+        if (feedbackElapsed <= FEEDBACK_DURATION)
+            return FEEDBACK_PENDING;
+
+        showingFeedback = false;
+        size_t uLevel = static_cast<size_t>(currentLevel);
+        if (uLevel >= bank.levelCount()) {
+            gameState = MENU;
+            return FEEDBACK_RETURN_TO_MENU;
+        }
 
-    Bullet(const sf::Texture& texture, float speed_) : speed(speed_) {
-        sprite.setTexture(texture);
-        sprite.setOrigin(texture.getSize().x / 2.f, texture.getSize().y / 2.f);
+        if (!runComplete()) {
+            currentQuestionIndex = pickQuestion();
+            return FEEDBACK_NEXT_QUESTION;
+        }
+
+        // Completed current level; unlock next only if lives > 0
+        recordScore();
+        if (lives > 0) {
+            size_t nextL = uLevel + 1;
+            if (nextL < bank.levelCount() && nextL < levelUnlocked.size()) {
+                levelUnlocked[nextL] = true;
+            }
+        }
+        gameState = LEVEL_SELECTION;
+        return FEEDBACK_LEVEL_COMPLETE;
     }
 
-    void update() {
-        sprite.move(0.f, -speed); // Move bullet upward
+private:
+    // Update the schedule and ratings for one answer; returns the player rating change
+    float review(int levelIdx, int questionIdx, bool correct, uint32_t latencyMs) {
+        const Level& level = bank.level(levelIdx);
+        scheduler.review(level, questionIdx, correct);
+        return difficulty.update(levelIdx, level.firstQuestion + static_cast<uint32_t>(questionIdx), correct, latencyMs / 1000.f);
     }
 
-    bool isOffScreen() const {
-        return sprite.getPosition().y < 0; // Off screen if above window
+    void recordScore() {
+        if (static_cast<size_t>(currentLevel) < bestScore.size())
+            bestScore[currentLevel] = std::max(bestScore[currentLevel], static_cast<uint32_t>(std::max(0, score)));
     }
 
-    void setPosition(const sf::Vector2f& position) {
-        sprite.setPosition(position);
+    // A due review not yet asked this run, else the difficulty model's choice, else
+    // (only when every question was asked) the first question
+    int pickQuestion() {
+        const Level& level = bank.level(currentLevel);
+        int review = scheduler.nextDue(level, askedThisRun);
+        if (review >= 0)
+            return review;
+        int picked = difficulty.pick(bank, currentLevel, askedThisRun, rng);
+        return picked >= 0 ? picked : 0;
     }
 };
 
-// --- Shooter Class ---
-// Player's shooter entity with bullet firing capability
-class Shooter {
-public:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    sf::Texture bulletTexture;
-    std::vector<Bullet> bullets;
-    float bulletSpeed;
+// --- SaveGame ---
+// Player progress in a compact, versioned binary file: level unlocks, best
+// scores, the player rating, and the schedule and rating of every question that
+// was answered at least once (unanswered ones are rebuilt from the bank, so the
+// file grows with play rather than with the bank).
+//
+// Layout (little-endian): SaveGameHeader, unlock bits ((levelCount + 7) / 8 bytes),
+// best scores (uint32 per level), then recordCount SaveQuestionRecords sorted by
+// question id. The checksum covers the whole file, taken with the checksum field zeroed.
+struct SaveGameHeader {
+    char magic[4];          // "CBSV"
+    uint32_t version;
+    uint32_t bankChecksum;  // progress only applies to the bank it was made for
+    uint32_t levelCount;
+    uint32_t questionCount;
+    uint32_t recordCount;
+    uint32_t reviewClock;
+    float playerRating;
+    uint32_t checksum;
+    uint32_t journalSequence; // last answer-journal record this save includes
+};
+struct SaveQuestionRecord {
+    uint32_t id;
+    uint32_t due;
+    uint32_t interval;
+    float rating;
+    uint16_t ease;
+    uint8_t repetitions;
+    uint8_t reserved;
+};
+static_assert(sizeof(SaveGameHeader) == 40 && sizeof(SaveQuestionRecord) == 20, "save records must have no padding");
 
-    Shooter() : bulletSpeed(10.f) {}
+// Version 2 checksums the header and gives journalSequence its meaning; version 1
+// files had a reserved zero there and are not loaded
+const uint32_t SAVE_GAME_VERSION = 2;
 
-    // hooter and bullet loaded textures from files
-    bool loadTextures(const std::string& shooterPath, const std::string& bulletPath) {
-        if (!texture.loadFromFile(shooterPath)) {
-            std::cerr << "Error loading shooter texture: " << shooterPath << std::endl;
-            return false;
+// Checksum of a save game image whose header is given separately; header.checksum is ignored
+inline uint32_t saveGameChecksum(SaveGameHeader header, const char* body, size_t bodySize) {
+    header.checksum = 0;
+    return fnv1a(body, bodySize, fnv1a(reinterpret_cast<const char*>(&header), sizeof(header)));
+}
+
+// Serialize logic's progress, which includes journaled answers up to journalSequence,
+// into out (reusing its storage)
+inline void encodeSaveGame(const GameLogic& logic, uint32_t journalSequence, std::vector<char>& out) {
+    const QuestionBank& bank = logic.bank;
+    const size_t levels = bank.levelCount();
+    uint32_t records = 0;
+    for (uint32_t id = 0; id < logic.scheduler.size(); ++id)
+        if (logic.scheduler.answered(id)) ++records;
+
+    const size_t unlockBytes = (levels + 7) / 8;
+    out.assign(sizeof(SaveGameHeader) + unlockBytes + levels * sizeof(uint32_t) + records * sizeof(SaveQuestionRecord), 0);
+    char* p = out.data() + sizeof(SaveGameHeader);
+    for (size_t l = 0; l < levels; ++l)
+        if (logic.isLevelUnlocked(static_cast<int>(l)))
+            p[l / 8] |= static_cast<char>(1 << (l % 8));
+    p += unlockBytes;
+    std::memcpy(p, logic.bestScore.data(), levels * sizeof(uint32_t));
+    p += levels * sizeof(uint32_t);
+    for (uint32_t id = 0; id < logic.scheduler.size(); ++id) {
+        if (!logic.scheduler.answered(id)) continue;
+        QuestionScheduler::Entry e = logic.scheduler.entry(id);
+        SaveQuestionRecord r = { id, e.due, e.interval, logic.difficulty.rating(id), e.ease, e.repetitions, 0 };
+        std::memcpy(p, &r, sizeof(r));
+        p += sizeof(r);
+    }
+
+    SaveGameHeader header;
+    std::memcpy(header.magic, "CBSV", 4);
+    header.version = SAVE_GAME_VERSION;
+    header.bankChecksum = bank.checksum();
+    header.levelCount = static_cast<uint32_t>(levels);
+    header.questionCount = static_cast<uint32_t>(bank.questionCount());
+    header.recordCount = records;
+    header.reviewClock = logic.scheduler.reviewClock();
+    header.playerRating = logic.difficulty.playerRating;
+    header.journalSequence = journalSequence;
+    header.checksum = saveGameChecksum(header, out.data() + sizeof(header), out.size() - sizeof(header));
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+// Restore progress saved by encodeSaveGame over logic's fresh state. Nothing is
+// changed unless the whole file checks out against the loaded bank. journalSequence
+// receives the last journaled answer the save includes.
+inline bool decodeSaveGame(const char* data, size_t size, GameLogic& logic, uint32_t& journalSequence, const std::string& path) {
+    const QuestionBank& bank = logic.bank;
+    SaveGameHeader header;
+    if (size < sizeof(header)) {
+        std::cerr << "Warning loading save game " << path << ": file is truncated\n";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "CBSV", 4) != 0 || header.version != SAVE_GAME_VERSION) {
+        std::cerr << "Warning loading save game " << path << ": not a save game or unsupported version\n";
+        return false;
+    }
+    const size_t levels = header.levelCount;
+    const size_t unlockBytes = (levels + 7) / 8;
+    if (size != sizeof(header) + unlockBytes + levels * sizeof(uint32_t) + size_t(header.recordCount) * sizeof(SaveQuestionRecord)
+        || header.checksum != saveGameChecksum(header, data + sizeof(header), size - sizeof(header))) {
+        std::cerr << "Warning loading save game " << path << ": file is damaged\n";
+        return false;
+    }
+    if (header.bankChecksum != bank.checksum() || levels != bank.levelCount() || header.questionCount != bank.questionCount()) {
+        std::cerr << "Warning loading save game " << path << ": made for a different question bank, starting fresh\n";
+        return false;
+    }
+    // Ratings feed float-to-int bucket conversions, so a NaN or infinity must never get in
+    const char* records = data + sizeof(header) + unlockBytes + levels * sizeof(uint32_t);
+    bool finite = std::isfinite(header.playerRating);
+    for (uint32_t i = 0; finite && i < header.recordCount; ++i) {
+        float rating;
+        std::memcpy(&rating, records + i * sizeof(SaveQuestionRecord) + offsetof(SaveQuestionRecord, rating), sizeof(rating));
+        finite = std::isfinite(rating);
+    }
+    if (!finite) {
+        std::cerr << "Warning loading save game " << path << ": file is damaged\n";
+        return false;
+    }
+
+    const char* p = data + sizeof(header);
+    for (size_t l = 0; l < levels; ++l)
+        logic.levelUnlocked[l] = l == 0 || (p[l / 8] & (1 << (l % 8))) != 0;
+    p += unlockBytes;
+    std::memcpy(logic.bestScore.data(), p, levels * sizeof(uint32_t));
+    p += levels * sizeof(uint32_t);
+    for (uint32_t i = 0; i < header.recordCount; ++i, p += sizeof(SaveQuestionRecord)) {
+        SaveQuestionRecord r;
+        std::memcpy(&r, p, sizeof(r));
+        if (r.id >= header.questionCount) continue;
+        QuestionScheduler::Entry e = { r.due, r.interval, r.ease, r.repetitions };
+        logic.scheduler.restore(r.id, e);
+        logic.difficulty.restore(r.id, r.rating);
+    }
+    logic.scheduler.rebuild(bank, header.reviewClock);
+    logic.difficulty.playerRating = header.playerRating;
+    logic.difficulty.rebuild(bank);
+    journalSequence = header.journalSequence;
+    return true;
+}
+
+// Rename from to to, replacing any file already there
+inline bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// Write data to path + ".tmp", flush it to disk and rename it over path, so a crash
+// leaves either the old file or the new one, never a torn mix
+inline bool writeFileAtomically(const std::string& path, const char* data, size_t size) {
+    const std::string temp = path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(data, 1, size, file) == size && std::fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))));
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    ok = ok && replaceFile(temp, path);
+    if (!ok)
+        std::remove(temp.c_str());
+    return ok;
+}
+
+// Writes save games on a background thread so a frame never waits for the disk.
+// The frame only encodes into a buffer and swaps it in; if saves arrive faster than
+// the disk takes them, only the newest pending one is written. An optional callback
+// runs on the writer thread once a save is safely on disk.
+class SaveWriter {
+public:
+    SaveWriter() : stopping(false), pending(false), writing(false) {}
+
+    ~SaveWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
         }
-        if (!bulletTexture.loadFromFile(bulletPath)) {
-            std::cerr << "Error loading bullet texture: " << bulletPath << std::endl;
-            return false;
+        wake.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    SaveWriter(const SaveWriter&) = delete;
+    SaveWriter& operator=(const SaveWriter&) = delete;
+
+    // Queue data for path; data is swapped out, so the caller's buffer comes back with old capacity
+    void submit(const std::string& path, std::vector<char>& data, std::function<void()> written = std::function<void()>()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingPath = path;
+            pendingData.swap(data);
+            pendingWritten.swap(written);
+            pending = true;
         }
-        sprite.setTexture(texture);
-        sprite.setOrigin(texture.getSize().x / 2.f, texture.getSize().y / 2.f);
-        sprite.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT - 100);
-        return true;
+        if (!worker.joinable())
+            worker = std::thread(&SaveWriter::workerLoop, this);
+        wake.notify_all();
     }
 
-    // Create a new bullet at the tip of the shooter
-    void shoot() {
-        Bullet bullet(bulletTexture, bulletSpeed);
-        bullet.setPosition({ sprite.getPosition().x, sprite.getPosition().y - sprite.getGlobalBounds().height / 2.f });
-        bullets.push_back(bullet);
+    // Block until every submitted save is on disk
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return !pending && !writing; });
     }
 
-    // Update bullets' position and remove off-screen bullets
-    void update() {
-        for (auto& bullet : bullets)
-            bullet.update();
-        bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
-            [](const Bullet& b) { return b.isOffScreen(); }), bullets.end());
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread worker;
+    bool stopping;
+    bool pending;
+    bool writing;
+    std::string pendingPath;
+    std::vector<char> pendingData;
+    std::vector<char> writeData;
+    std::function<void()> pendingWritten;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return pending || stopping; });
+            if (!pending)
+                return; // stopping, and everything is written
+            std::string path = pendingPath;
+            writeData.swap(pendingData);
+            std::function<void()> written;
+            written.swap(pendingWritten);
+            pending = false;
+            writing = true;
+            lock.unlock();
+
+            if (!writeFileAtomically(path, writeData.data(), writeData.size()))
+                std::cerr << "Error writing save game: " << path << std::endl;
+            else if (written)
+                written();
+
+            lock.lock();
+            writing = false;
+            idle.notify_all();
+        }
     }
+};
 
-    // Draw shooter and all bullets
-    void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
-        for (const auto& bullet : bullets)
-            window.draw(bullet.sprite);
+// Read and decode a save game with a single read of the whole file; a missing file is not an error
+inline bool loadSaveGame(const std::string& path, GameLogic& logic, uint32_t& journalSequence) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false; // nothing saved yet
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!data.empty() && !file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+        std::cerr << "Warning loading save game " << path << ": read failed\n";
+        return false;
     }
+    return decodeSaveGame(data.data(), data.size(), logic, journalSequence, path);
+}
+
+// --- AnswerJournal Class ---
+// Append-only write-ahead log of every answer, so classroom sessions keep each one
+// even if the game is killed between save games. checkAnswer() only queues a record.
+// A dedicated I/O thread commits everything queued within JOURNAL_COMMIT_INTERVAL_MS
+// with a single write and flush to disk (group commit), so a crash loses at most one
+// commit window.
+//
+// The save game acts as the snapshot: it stores the sequence number of the last
+// answer it includes. On startup the journal's later answers are replayed on top of
+// it. After enough answers, once a save game covering them is on disk, the journal is
+// compacted: the answers the snapshot covers are dropped by atomically replacing the
+// file, so replay stays short.
+//
+// Layout: JournalHeader, then 32-byte JournalRecords. Each record carries its own
+// checksum, so a record torn by a crash is recognised and cut off.
+struct JournalHeader {
+    char magic[4];          // "CBAJ"
+    uint32_t version;
+    uint32_t bankChecksum;
+    uint32_t reserved;
 };
+struct JournalRecord {
+    uint64_t timestampMs;   // wall clock, ms since the Unix epoch
+    uint32_t sequence;      // one per answer, increasing across compactions
+    uint32_t player;        // FNV-1a of the player name
+    uint32_t questionId;    // position in the question bank
+    int16_t option;
+    uint8_t correct;
+    uint8_t reserved;
+    uint32_t latencyMs;     // time from the question appearing to the answer
+    uint32_t checksum;      // FNV-1a of the fields above
+};
+static_assert(sizeof(JournalHeader) == 16 && sizeof(JournalRecord) == 32, "journal records must have no padding");
 
-// --- Button Class ---
-// UI Button with support for multi-line text and hover/disabled states
-class Button {
+const uint32_t JOURNAL_VERSION = 1;
+const unsigned JOURNAL_COMMIT_INTERVAL_MS = 100; // Group commit window; a crash loses at most this much
+const size_t JOURNAL_COMPACT_RECORDS = 1024;     // Answers kept before a save game compacts the journal
+
+class AnswerJournal {
 public:
-    sf::RectangleShape rect;
-    std::vector<sf::Text> textLines;
-    sf::Font& font;
-    unsigned int charSize;
-    sf::Color idleColor = sf::Color(70, 70, 150);
-    sf::Color hoverColor = sf::Color(120, 120, 220);
-    sf::Color textColor = sf::Color::White;
-    sf::Color disabledColor = sf::Color(50, 50, 100);
-    sf::Color disabledTextColor = sf::Color(110, 110, 160);
-    bool enabled = true;
+    AnswerJournal()
+        : file(nullptr), active(false), stopping(false), snapshotReady(false), snapshotSequence(0),
+        nextSequence(1), bankChecksum(0) {}
+
+    ~AnswerJournal() { close(); }
+
+    AnswerJournal(const AnswerJournal&) = delete;
+    AnswerJournal& operator=(const AnswerJournal&) = delete;
+
+    // Read the journal at path with a single read and return, through replay, the
+    // answers after sequence `since` (the last one the save game includes). A torn
+    // tail is cut off; a journal for another bank, or one that isn't a journal, is
+    // moved to path + ".bak" and a new one started. Then start the I/O thread.
+    bool open(const std::string& path_, uint32_t bankChecksum_, uint32_t since, std::vector<JournalRecord>& replay) {
+        path = path_;
+        bankChecksum = bankChecksum_;
+        nextSequence = since + 1;
+        replay.clear();
+
+        std::vector<char> data;
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (in) {
+            data.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            if (!data.empty() && !in.read(data.data(), static_cast<std::streamsize>(data.size())))
+                data.clear();
+        }
+        in.close();
+
+        JournalHeader header;
+        bool usable = data.size() >= sizeof(header);
+        if (!usable && !data.empty())
+            std::cerr << "Warning loading answer journal " << path << ": file is truncated\n";
+        if (usable) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            usable = std::memcmp(header.magic, "CBAJ", 4) == 0 && header.version == JOURNAL_VERSION;
+            if (!usable)
+                std::cerr << "Warning loading answer journal " << path << ": not a journal or unsupported version\n";
+            else if (header.bankChecksum != bankChecksum) {
+                std::cerr << "Warning loading answer journal " << path << ": made for a different question bank\n";
+                usable = false;
+            }
+        }
 
-    // Constructor to create button with size, position, text, font and character size
-    Button(sf::Vector2f size, sf::Vector2f position, const std::string& buttonText, sf::Font& btnFont, unsigned int charSize_ = 20)
-        : font(btnFont), charSize(charSize_)
-    {
-        rect.setSize(size);
-        rect.setFillColor(idleColor);
-        rect.setPosition(position);
-        rect.setOrigin(size.x / 2.f, size.y / 2.f);
+        size_t valid = 0, count = usable ? (data.size() - sizeof(header)) / sizeof(JournalRecord) : 0;
+        for (; valid < count; ++valid) {
+            JournalRecord r;
+            std::memcpy(&r, data.data() + sizeof(header) + valid * sizeof(r), sizeof(r));
+            if (r.checksum != recordChecksum(r))
+                break;
+            committed.push_back(r);
+            if (r.sequence > since)
+                replay.push_back(r);
+            nextSequence = std::max(nextSequence, r.sequence + 1);
+        }
+        if (usable && valid < count)
+            std::cerr << "Warning loading answer journal " << path << ": dropped " << count - valid << " damaged record(s) at the end\n";
+
+        // Keep a journal that can't be used here instead of truncating it
+        if (!usable && !data.empty()) {
+            if (!replaceFile(path, path + ".bak")) {
+                std::cerr << "Error moving answer journal aside, answers won't be journaled: " << path << std::endl;
+                return false;
+            }
+            std::cerr << "Warning: kept the answer journal that couldn't be loaded as " << path << ".bak\n";
+        }
 
-        // Split multi-line text by lines and create sf::Text for each
-        std::istringstream iss(buttonText);
-        std::string line;
-        float lineHeight = charSize * 1.3f;
-        std::vector<sf::Text> tempLines;
-        float totalHeight = 0.f;
-
-        while (std::getline(iss, line)) {
-            sf::Text textLine;
-            textLine.setFont(font);
-            textLine.setString(line);
-            textLine.setCharacterSize(charSize);
-            textLine.setFillColor(textColor);
-            sf::FloatRect bounds = textLine.getLocalBounds();
-            textLine.setOrigin(bounds.left + bounds.width / 2.f, bounds.top + bounds.height / 2.f);
-            tempLines.push_back(textLine);
-            totalHeight += lineHeight;
-        }
-
-        // Position each text line vertically centered in button
-        float startY = position.y - totalHeight / 2.f + lineHeight / 2.f;
-        for (unsigned i = 0; i < tempLines.size(); ++i) {
-            tempLines[i].setPosition(position.x, startY + i * lineHeight);
-            textLines.push_back(tempLines[i]);
+        // Start over with a clean file unless it is intact up to its last record
+        if (!usable || sizeof(header) + valid * sizeof(JournalRecord) != data.size()) {
+            if (!rewrite()) {
+                std::cerr << "Error writing answer journal: " << path << std::endl;
+                return false;
+            }
+        }
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            std::cerr << "Error opening answer journal: " << path << std::endl;
+            return false;
         }
+        active = true;
+        worker = std::thread(&AnswerJournal::ioLoop, this);
+        return true;
     }
 
-    // Update button color based on mouse position and enabled state
-    void updateColor(const sf::Vector2i& mousePos) {
-        if (!enabled) {
-            rect.setFillColor(disabledColor);
-            for (auto& t : textLines) t.setFillColor(disabledTextColor);
+    bool isOpen() const { return active; }
+
+    // Sequence number of the last answer appended (or replayed)
+    uint32_t lastSequence() const { return nextSequence - 1; }
+
+    // Queue an answer for the next group commit; never touches the disk
+    void append(uint32_t player, uint32_t questionId, int option, bool correct, uint32_t latencyMs) {
+        if (!active) return;
+        JournalRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.timestampMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        r.sequence = nextSequence++;
+        r.player = player;
+        r.questionId = questionId;
+        r.option = static_cast<int16_t>(option);
+        r.correct = correct ? 1 : 0;
+        r.latencyMs = latencyMs;
+        r.checksum = recordChecksum(r);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(r);
         }
-        else if (isMouseOver(mousePos)) {
-            rect.setFillColor(hoverColor);
-            for (auto& t : textLines) t.setFillColor(textColor);
+        wake.notify_all();
+    }
+
+    // A save game including every answer up to sequence is on disk; once enough answers
+    // have built up, the I/O thread drops the ones it covers. Safe to call from any thread.
+    void snapshotWritten(uint32_t sequence) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshotSequence = std::max(snapshotSequence, sequence);
+            snapshotReady = true;
         }
-        else {
-            rect.setFillColor(idleColor);
-            for (auto& t : textLines) t.setFillColor(textColor);
+        wake.notify_all();
+    }
+
+    // Commit whatever is queued and stop the I/O thread
+    void close() {
+        if (!worker.joinable()) return;
+        active = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
         }
+        wake.notify_all();
+        worker.join();
+        if (file)
+            std::fclose(file);
+        file = nullptr;
     }
 
-    // Check if mouse is over button (only if enabled)
-    bool isMouseOver(const sf::Vector2i& mousePos) const {
-        sf::Vector2f mf(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
-        return enabled && rect.getGlobalBounds().contains(mf);
+private:
+    std::string path;
+    FILE* file;                          // open for appending; only the I/O thread uses it after open()
+    bool active;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::vector<JournalRecord> pending;  // queued by append(), guarded by mutex
+    bool snapshotReady;                  // guarded by mutex
+    uint32_t snapshotSequence;           // newest save game on disk, guarded by mutex
+    uint32_t nextSequence;               // main thread only
+    uint32_t bankChecksum;
+    std::vector<JournalRecord> committed; // records in the file; I/O thread only after open()
+    std::vector<JournalRecord> batch;
+
+    static uint32_t recordChecksum(const JournalRecord& r) {
+        return fnv1a(reinterpret_cast<const char*>(&r), offsetof(JournalRecord, checksum));
     }
 
-    // Draw button rectangle and text lines
-    void draw(sf::RenderWindow& window) const {
-        window.draw(rect);
-        for (const auto& t : textLines) window.draw(t);
+    // Replace the file with the header and the committed records
+    bool rewrite() {
+        std::vector<char> data(sizeof(JournalHeader) + committed.size() * sizeof(JournalRecord));
+        JournalHeader header;
+        std::memcpy(header.magic, "CBAJ", 4);
+        header.version = JOURNAL_VERSION;
+        header.bankChecksum = bankChecksum;
+        header.reserved = 0;
+        std::memcpy(data.data(), &header, sizeof(header));
+        if (!committed.empty())
+            std::memcpy(data.data() + sizeof(header), committed.data(), committed.size() * sizeof(JournalRecord));
+        return writeFileAtomically(path, data.data(), data.size());
     }
 
-    // Enable or disable button and update color accordingly
-    void setEnabled(bool val) {
-        enabled = val;
-        updateColor({ -1, -1 }); // Mouse position invalid, just refresh color
+    bool commit(const std::vector<JournalRecord>& records) {
+        if (!file)
+            return false;
+        bool ok = std::fwrite(records.data(), sizeof(JournalRecord), records.size(), file) == records.size()
+            && std::fflush(file) == 0;
+#ifdef _WIN32
+        ok = ok && FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))));
+#else
+        ok = ok && fsync(fileno(file)) == 0;
+#endif
+        return ok;
     }
-};
 
-// --- Question Struct ---
-// Represents a multiple-choice question for a level
-struct Question {
-    std::string questionText;
-    std::vector<std::string> options;
-    int correctOptionIndex;
+    void ioLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !pending.empty() || snapshotReady; });
+            // Gather the commit window: everything appended in the next few milliseconds goes in one write
+            if (!stopping && !pending.empty())
+                wake.wait_for(lock, std::chrono::milliseconds(JOURNAL_COMMIT_INTERVAL_MS), [this] { return stopping; });
+            batch.swap(pending);
+            uint32_t snapshot = snapshotReady ? snapshotSequence : 0;
+            snapshotReady = false;
+            bool stop = stopping;
+            lock.unlock();
+
+            if (!batch.empty()) {
+                if (!commit(batch))
+                    std::cerr << "Error writing answer journal: " << path << std::endl;
+                committed.insert(committed.end(), batch.begin(), batch.end());
+                batch.clear();
+            }
+            if (snapshot > 0 && committed.size() >= JOURNAL_COMPACT_RECORDS && committed.front().sequence <= snapshot)
+                compact(snapshot);
+
+            lock.lock();
+            if (stop && pending.empty())
+                return;
+        }
+    }
 
-    Question() : correctOptionIndex(0) {}
-    Question(const std::string& q, const std::vector<std::string>& opts, int correct)
-        : questionText(q), options(opts), correctOptionIndex(correct) {
+    // Drop records the snapshot covers and reopen the shorter file for appending
+    void compact(uint32_t snapshot) {
+        std::vector<JournalRecord> kept;
+        for (const JournalRecord& r : committed)
+            if (r.sequence > snapshot) kept.push_back(r);
+        if (file)
+            std::fclose(file);
+        std::vector<JournalRecord> previous;
+        previous.swap(committed);
+        committed.swap(kept);
+        if (!rewrite()) {
+            std::cerr << "Error compacting answer journal: " << path << std::endl;
+            committed.swap(previous); // the old file is still in place
+        }
+        file = std::fopen(path.c_str(), "ab");
+        if (!file)
+            std::cerr << "Error opening answer journal: " << path << std::endl;
     }
 };
 
-// --- Level Struct ---
-// Represents a level that contains questions
-struct Level {
-    std::string levelName;
-    std::vector<Question> questions;
-    Level() {}
-    Level(const std::string& name, const std::vector<Question>& qs) : levelName(name), questions(qs) {}
+// --- InputLog Class ---
+// Compact binary log of the input a windowed session handled, stamped with the
+// simulation tick it was handled on. Game logic only changes on input and fixed
+// steps, so feeding the same events at the same ticks, with the same seed, mouse
+// start position and question bank, reproduces the session.
+//
+// Layout: InputLogHeader, then recordCount 16-byte Records.
+struct InputLogHeader {
+    char magic[4];          // "CBIR"
+    uint32_t version;
+    uint32_t seed;
+    uint32_t bankChecksum;  // QuestionBank::checksum() of the bank that was played
+    int32_t mouseX;         // mouse position when the session started
+    int32_t mouseY;
+    uint32_t endTick;       // tick the session ended on
+    uint32_t recordCount;
 };
+static_assert(sizeof(InputLogHeader) == 32, "InputLogHeader must not contain padding");
 
-// --- Explosion Class ---
-// Handles animated explosion sprite for incorrect answers
-class Explosion {
+const uint32_t INPUT_LOG_VERSION = 1;
+
+class InputLog {
 public:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    int frameWidth = 0;
-    int frameHeight = 0;
-    int numFrames = 0;
-    int currentFrame = 0;
-    float frameDuration = 0.05f;
-    float timer = 0.f;
-    bool isPlaying = false;
-    sf::Clock clock;
+    struct Record {
+        uint32_t tick;
+        uint16_t type;
+        int16_t code; // key code, mouse button, or wheel delta * 100
+        int32_t x;    // mouse position, or key modifier bits
+        int32_t y;
+    };
+
+    InputLogHeader header;
+    std::vector<Record> records;
+
+    InputLog() {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "CBIR", 4);
+        header.version = INPUT_LOG_VERSION;
+    }
 
-    Explosion() : currentFrame(0), timer(0.f), isPlaying(false) {}
+    // Append an event the game handles; other event types are not needed for replay
+    void record(uint32_t tick, const sf::Event& event) {
+        Record r = { tick, 0, 0, 0, 0 };
+        switch (event.type) {
+        case sf::Event::Closed:
+            r.type = INPUT_CLOSED;
+            break;
+        case sf::Event::KeyPressed:
+            r.type = INPUT_KEY;
+            r.code = static_cast<int16_t>(event.key.code);
+            r.x = (event.key.alt ? 1 : 0) | (event.key.control ? 2 : 0) | (event.key.shift ? 4 : 0) | (event.key.system ? 8 : 0);
+            break;
+        case sf::Event::MouseMoved:
+            r.type = INPUT_MOUSE_MOVE;
+            r.x = event.mouseMove.x;
+            r.y = event.mouseMove.y;
+            break;
+        case sf::Event::MouseButtonPressed:
+            r.type = INPUT_MOUSE_PRESS;
+            r.code = static_cast<int16_t>(event.mouseButton.button);
+            r.x = event.mouseButton.x;
+            r.y = event.mouseButton.y;
+            break;
+        case sf::Event::MouseWheelScrolled:
+            r.type = INPUT_MOUSE_WHEEL;
+            r.code = static_cast<int16_t>(event.mouseWheelScroll.delta * 100.f);
+            r.x = event.mouseWheelScroll.x;
+            r.y = event.mouseWheelScroll.y;
+            break;
+        default:
+            return;
+        }
+        records.push_back(r);
+    }
 
-    // Load explosion spritesheet texture and calculate frames
-    bool loadTexture(const std::string& path, int frames) {
-        if (!texture.loadFromFile(path)) {
-            std::cerr << "Error loading explosion texture: " << path << std::endl;
+    // Rebuild the sf::Event a record was made from
+    static sf::Event toEvent(const Record& r) {
+        sf::Event event;
+        std::memset(&event, 0, sizeof(event));
+        switch (r.type) {
+        case INPUT_KEY:
+            event.type = sf::Event::KeyPressed;
+            event.key.code = static_cast<sf::Keyboard::Key>(r.code);
+            event.key.alt = (r.x & 1) != 0;
+            event.key.control = (r.x & 2) != 0;
+            event.key.shift = (r.x & 4) != 0;
+            event.key.system = (r.x & 8) != 0;
+            break;
+        case INPUT_MOUSE_MOVE:
+            event.type = sf::Event::MouseMoved;
+            event.mouseMove.x = r.x;
+            event.mouseMove.y = r.y;
+            break;
+        case INPUT_MOUSE_PRESS:
+            event.type = sf::Event::MouseButtonPressed;
+            event.mouseButton.button = static_cast<sf::Mouse::Button>(r.code);
+            event.mouseButton.x = r.x;
+            event.mouseButton.y = r.y;
+            break;
+        case INPUT_MOUSE_WHEEL:
+            event.type = sf::Event::MouseWheelScrolled;
+            event.mouseWheelScroll.wheel = sf::Mouse::VerticalWheel;
+            event.mouseWheelScroll.delta = r.code / 100.f;
+            event.mouseWheelScroll.x = r.x;
+            event.mouseWheelScroll.y = r.y;
+            break;
+        default:
+            event.type = sf::Event::Closed;
+            break;
+        }
+        return event;
+    }
+
+    bool save(const std::string& path) {
+        header.recordCount = static_cast<uint32_t>(records.size());
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file
+            || !file.write(reinterpret_cast<const char*>(&header), sizeof(header))
+            || (!records.empty() && !file.write(reinterpret_cast<const char*>(&records[0]),
+                static_cast<std::streamsize>(records.size() * sizeof(Record))))) {
+            std::cerr << "Error writing input log: " << path << std::endl;
             return false;
         }
-        numFrames = frames;
-        frameWidth = texture.getSize().x / numFrames;
-        frameHeight = texture.getSize().y;
-        sprite.setTexture(texture);
-        sprite.setTextureRect(sf::IntRect(0, 0, frameWidth, frameHeight));
-        sprite.setOrigin(frameWidth / 2.f, frameHeight / 2.f);
+        std::cout << "Recorded " << records.size() << " input events over " << header.endTick << " ticks to " << path << std::endl;
         return true;
     }
 
-    // Start animation at given position
-    void start(sf::Vector2f position) {
-        if (frameWidth <= 0) return;
-        sprite.setPosition(position);
-        currentFrame = 0;
-        isPlaying = true;
-        sprite.setTextureRect(sf::IntRect(0, 0, frameWidth, frameHeight));
-        clock.restart();
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        const std::streamoff size = file ? static_cast<std::streamoff>(file.tellg()) : 0;
+        file.seekg(0);
+        if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            std::cerr << "Error opening input log: " << path << std::endl;
+            return false;
+        }
+        if (std::memcmp(header.magic, "CBIR", 4) != 0 || header.version != INPUT_LOG_VERSION) {
+            std::cerr << "Error in input log " << path << ": not an input log or unsupported version" << std::endl;
+            return false;
+        }
+        // Check the count against the file before trusting it with an allocation
+        if (static_cast<uint64_t>(size) - sizeof(header) != uint64_t(header.recordCount) * sizeof(Record)) {
+            std::cerr << "Error in input log " << path << ": record count does not match file size" << std::endl;
+            return false;
+        }
+        records.resize(header.recordCount);
+        if (!records.empty() && !file.read(reinterpret_cast<char*>(&records[0]),
+            static_cast<std::streamsize>(records.size() * sizeof(Record)))) {
+            std::cerr << "Error in input log " << path << ": file is truncated" << std::endl;
+            return false;
+        }
+        return true;
     }
 
-    // Update animation frames based on time elapsed
-    void update() {
-        if (!isPlaying) return;
+private:
+    enum Type { INPUT_CLOSED, INPUT_KEY, INPUT_MOUSE_MOVE, INPUT_MOUSE_PRESS, INPUT_MOUSE_WHEEL };
+};
 
-        timer += clock.restart().asSeconds();
+// --- BenchReport Class ---
+// Collects --bench results, compares them with a baseline and writes them out.
+// Results are printed as JSON for tracking trends across builds. Baselines are
+// plain "scenario.key=value" lines, written and read back in the same format.
+class BenchReport {
+public:
+    struct Result {
+        std::string name;
+        double mean, p50, p95, p99, max;
+        double allocsPerFrame;
+        uint64_t maxAllocs;
+        size_t processPeakRss; // process-wide high-water mark once the scenario finished, not its own use
+    };
+
+    // Summarize one scenario from its per-frame times and allocations
+    void add(const std::string& name, const std::vector<double>& frameMs, const std::vector<uint64_t>& frameAllocs) {
+        const size_t n = frameMs.size();
+        Result r;
+        r.name = name;
+        r.mean = 0.0;
+        r.allocsPerFrame = 0.0;
+        r.maxAllocs = 0;
+        for (size_t i = 0; i < n; ++i) {
+            r.mean += frameMs[i];
+            r.allocsPerFrame += static_cast<double>(frameAllocs[i]);
+            r.maxAllocs = std::max(r.maxAllocs, frameAllocs[i]);
+        }
+        r.mean /= n;
+        r.allocsPerFrame /= n;
+        std::vector<double> sorted(frameMs);
+        std::sort(sorted.begin(), sorted.end());
+        r.p50 = sorted[n / 2];
+        r.p95 = sorted[n * 95 / 100];
+        r.p99 = sorted[n * 99 / 100];
+        r.max = sorted.back();
+        r.processPeakRss = peakResidentBytes();
+        results.push_back(r);
+    }
 
-        while (timer >= frameDuration && isPlaying) {
-            timer -= frameDuration;
-            currentFrame++;
-            if (currentFrame >= numFrames) {
-                isPlaying = false;
-                currentFrame = 0;
-                sprite.setTextureRect(sf::IntRect(0, 0, frameWidth, frameHeight));
-            }
-            else {
-                sprite.setTextureRect(sf::IntRect(currentFrame * frameWidth, 0, frameWidth, frameHeight));
-            }
+    // Compare with baselinePath (if given), write the JSON to outputPath (stdout if
+    // empty) and the new baseline to savePath (if given). Returns the process exit
+    // code: 1 if any scenario regressed past the baseline.
+    int finish(const std::string& outputPath, const std::string& baselinePath, const std::string& savePath) {
+        std::vector<std::string> regressions;
+        if (!baselinePath.empty() && loadBaseline(baselinePath))
+            compare(regressions);
+        writeJson(outputPath, regressions);
+        if (!savePath.empty())
+            saveBaseline(savePath);
+        for (const std::string& regression : regressions)
+            std::cerr << "Regression: " << regression << std::endl;
+        return regressions.empty() ? 0 : 1;
+    }
+
+private:
+    std::vector<Result> results;
+    std::map<std::string, double> baseline;
+
+    bool loadBaseline(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Warning: benchmark baseline " << path << " is missing.\n";
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t equals = line.find('=');
+            if (line.empty() || line[0] == '#' || equals == std::string::npos)
+                continue;
+            baseline[line.substr(0, equals)] = std::strtod(line.c_str() + equals + 1, nullptr);
+        }
+        return true;
+    }
+
+    // Baseline value of scenario.key, or -1 if the baseline doesn't have it
+    double baselineValue(const Result& r, const char* key) const {
+        std::map<std::string, double>::const_iterator it = baseline.find(r.name + "." + key);
+        return it == baseline.end() ? -1.0 : it->second;
+    }
+
+    // p95 frame time, mean allocations per frame and peak resident memory against the baseline
+    void compare(std::vector<std::string>& regressions) const {
+        for (const Result& r : results) {
+            double p95 = baselineValue(r, "p95_ms");
+            double allocs = baselineValue(r, "allocs_per_frame");
+            double rssKb = baselineValue(r, "process_peak_rss_kb");
+            std::ostringstream why;
+            if (p95 >= 0.0 && r.p95 > p95 * (1.0 + BENCH_TIME_TOLERANCE) + 0.05)
+                why << r.name << ": p95 " << r.p95 << " ms vs baseline " << p95 << " ms";
+            else if (allocs >= 0.0 && r.allocsPerFrame > allocs + BENCH_ALLOC_TOLERANCE)
+                why << r.name << ": " << r.allocsPerFrame << " allocations/frame vs baseline " << allocs;
+            else if (rssKb > 0.0 && r.processPeakRss / 1024.0 > rssKb * (1.0 + BENCH_RSS_TOLERANCE))
+                why << r.name << ": process peak RSS " << r.processPeakRss / 1024 << " KB vs baseline " << rssKb << " KB";
+            if (!why.str().empty())
+                regressions.push_back(why.str());
         }
     }
 
-    // Draw the explosion if playing
-    void draw(sf::RenderWindow& window) {
-        if (isPlaying)
-            window.draw(sprite);
+    void writeJson(const std::string& outputPath, const std::vector<std::string>& regressions) const {
+        std::ofstream fileOut;
+        if (!outputPath.empty()) {
+            fileOut.open(outputPath.c_str());
+            if (!fileOut)
+                std::cerr << "Error writing benchmark results: " << outputPath << std::endl;
+        }
+        std::ostream& out = fileOut.is_open() ? static_cast<std::ostream&>(fileOut) : std::cout;
+        out << "{\n  \"frames_per_scenario\": " << BENCH_FRAMES << ",\n  \"time_step_ms\": " << SIM_TIME_STEP * 1000.f
+            << ",\n  \"scenarios\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "    { \"name\": \"" << r.name << "\", \"mean_ms\": " << r.mean << ", \"p50_ms\": " << r.p50
+                << ", \"p95_ms\": " << r.p95 << ", \"p99_ms\": " << r.p99 << ", \"max_ms\": " << r.max
+                << ", \"allocs_per_frame\": " << r.allocsPerFrame << ", \"max_allocs_per_frame\": " << r.maxAllocs
+                << ", \"process_peak_rss_kb\": " << r.processPeakRss / 1024 << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"regressions\": [";
+        for (size_t i = 0; i < regressions.size(); ++i)
+            out << (i ? ", " : "") << "\"" << regressions[i] << "\"";
+        out << "]\n}\n";
     }
+
+    void saveBaseline(const std::string& path) const {
+        std::ofstream out(path.c_str());
+        if (!out) {
+            std::cerr << "Error writing benchmark baseline: " << path << std::endl;
+            return;
+        }
+        out << "# Code Blaster benchmark baseline: scenario.key=value\n";
+        out.precision(6);
+        for (const Result& r : results) {
+            out << r.name << ".p95_ms=" << r.p95 << "\n"
+                << r.name << ".allocs_per_frame=" << r.allocsPerFrame << "\n"
+                << r.name << ".process_peak_rss_kb=" << r.processPeakRss / 1024 << "\n";
+        }
+    }
+};
+
+// --- GameOptions Struct ---
+// Settings for a windowed session, filled in from the command line
+struct GameOptions {
+    std::string questionBankPath = QUESTION_BANK_PATH;
+    bool assetReport = false;
+    std::string profilePath;  // --profile
+    std::string recordPath;   // --record
+    std::string replayPath;   // --replay
+    std::string progressPath = PROGRESS_PATH; // save game, loaded at start and saved after each run and on exit
+    std::string journalPath = JOURNAL_PATH;   // every answer since the save game, replayed at start
+    std::string player = "player";            // --player: name stamped on journaled answers
+    unsigned seed = 0;
+    bool seedGiven = false;   // otherwise the session is seeded from the clock
+    bool benchmark = false;   // --bench: hidden window, no vsync or music
+    bool allocationCheck = false; // --alloc-check: report heap allocations in steady-state IN_GAME frames
 };
 
 // --- Game Class ---
@@ -282,30 +3564,26 @@ public:
 class Game {
 private:
     sf::RenderWindow window;
-    sf::Font font;
+    AssetManager assets;
+    FontHandle font;
     sf::Music backgroundMusic;
-    sf::SoundBuffer correctSoundBuffer;
-    sf::SoundBuffer incorrectSoundBuffer;
-    sf::Sound correctSound;
-    sf::Sound incorrectSound;
+    SoundBufferHandle correctSoundBuffer;
+    SoundBufferHandle incorrectSoundBuffer;
+    VoicePool voices;
 
-    sf::Texture backgroundTexture;
+    TextureHandle backgroundTexture;
     sf::Sprite backgroundSprite;
 
-    sf::Texture homeImageTexture;
+    TextureAtlas spriteAtlas;
+    SpriteBatch spriteBatch;
     sf::Sprite homeImageSprite;
 
     Shooter shooter;
 
-    // Enumeration of game states
-    enum GameState { MENU, LEVEL_SELECTION, RULES, IN_GAME, GAME_OVER };
-    GameState gameState;
-
-    std::vector<Level> levels;
-    int currentLevel;
-    int currentQuestionIndex;
-    int score;
-    int lives;
+    // State machine, levels, score and lives shared with headless mode
+    GameLogic logic;
+    sf::Clock frameClock;
+    float frameAccumulator;
 
     // Menu Elements
     Button* startButton;
@@ -314,11 +3592,17 @@ private:
     sf::Text gameNameText;
 
     // Level Selection Elements
+    // Level list: only the rows in view have a Button, recycled from this pool as the list scrolls
     std::vector<Button> levelButtons;
+    std::vector<int> levelButtonLevel; // Level shown by each pooled button, or -1 if unused
+    float levelScroll;                 // Pixels the list is scrolled down
+    sf::View levelListView;            // Clips the list to its screen area
+    sf::RectangleShape levelScrollBar;
+    HitGrid levelHitGrid;   // Pooled level buttons by index, then the back button
+    int hoveredLevelWidget; // Id in levelHitGrid under the mouse, or -1
     sf::Text levelSelectText;
     Button* backToMenuFromLevelSelectButton;
-    std::vector<bool> levelUnlocked;
-    sf::Text escapeHintText;
+    CachedText escapeHintText;
 
     // Rules Screen Elements
     sf::Text rulesTitleText;
@@ -331,30 +3615,78 @@ private:
     std::vector<sf::Text> optionTexts;
     std::vector<sf::RectangleShape> optionBoxes;
     int selectedOption;
+    sf::Vector2i mousePosition; // Last position seen in a mouse event
+    HitGrid optionHitGrid;      // Answer boxes by option index
     sf::RectangleShape selectionIndicator;
-    sf::Text scoreTextBox;
+    CachedText scoreTextBox;
     sf::RectangleShape scoreBox;
-    sf::Text livesText;
-    sf::Text levelProgressText;
-    sf::Text feedbackText;
-    bool showingFeedback;
-    sf::Clock feedbackTimer;
+    CachedText livesText;
+    CachedText levelProgressText;
+    CachedText feedbackText;
     Explosion explosion;
 
+    // Asset loading progress bar
+    ScreenCache screenCache; // Menu, rules and game over are drawn from here while nothing changes
+    GlyphWarmer glyphWarmer;
+    sf::RectangleShape loadingBarBack;
+    sf::RectangleShape loadingBarFill;
+    CachedText loadingText;
+    int loadingPercent;
+    bool assetReport;
+
+    // Frame profiler (F3 toggles the overlay) and where to save its recording
+    FrameProfiler profiler;
+    std::string profilePath;
+    std::string questionBankPath;
+    std::string textScratch; // reused to build label strings without allocating
+    std::string progressPath; // empty when progress is not persisted
+    bool keepOldSave;         // progressPath holds a save that didn't load; moved to .bak before the first save
+    AnswerJournal journal;    // declared before saveWriter, whose callback uses it, so it outlives it
+    uint32_t playerId;
+    SaveWriter saveWriter;
+    std::vector<char> saveBuffer;
+
+    // --alloc-check: once a question has been on screen for a couple of frames,
+    // update and render must not allocate until the question or feedback changes
+    struct FrameState {
+        GameLogic::GameState state;
+        int level;
+        int question;
+        bool feedback;
+        bool operator==(const FrameState& other) const {
+            return state == other.state && level == other.level && question == other.question && feedback == other.feedback;
+        }
+    };
+    bool allocationCheck;
+    FrameState lastFrameState;
+    int steadyFrames;
+
+    // Input recording and replay. simTick counts fixed steps; all gameplay
+    // randomness must come from logic.rng so a replay sees the same sequence.
+    uint32_t simTick;
+    InputLog inputLog;
+    std::string recordPath;
+    bool replaying;
+    size_t replayNext; // next inputLog record to feed
+
     // Game Over Elements
     sf::Text gameOverText;
-    sf::Text finalScoreText;
+    CachedText finalScoreText;
     Button* backToMenuFromGameOverButton;
 
 public:
-    Game();
+    explicit Game(const GameOptions& options);
     ~Game();
     void run();
+    bool runBenchmark(BenchReport& report);
 
 private:
     void loadResources();
-    void loadLevels();
     void setupCommonText();
+    void setupLoadingBar();
+    void updateLoadingBar();
+    void prewarmGlyphs();
+    bool isLoading() const;
     void setupMenu();
     void setupLevelSelection();
     void setupRules();
@@ -363,29 +3695,73 @@ private:
     void loadQuestion(int levelIdx, int questionIdx);
     void updateScoreText();
     void updateLivesText();
+    void setEscapeHint(const std::string& hint, sf::Vector2f position, float anchorX);
     void processEvents();
+    void handleEvent(const sf::Event& event);
+    void dispatchEvent(const sf::Event& event);
+    void feedReplay();
+    bool canIdle() const;
+    void checkSteadyAllocations(uint64_t allocations);
+    void saveProgress();
+    void loadJournal(const std::string& path, uint32_t savedSequence);
     void processMenuEvents(const sf::Event& event);
     void processLevelSelectionEvents(const sf::Event& event);
     void processRulesEvents(const sf::Event& event);
     void processInGameEvents(const sf::Event& event);
     void processGameOverEvents(const sf::Event& event);
-    void update();
+    void update(float dt);
     void updateSelectionIndicator();
+    void updateHover();
+    Button& levelSelectionWidget(int id);
+    void layoutLevelList();
+    void scrollLevelList(float pixels);
     void checkAnswer(int selected);
-    void render();
+    void render(sf::RenderTarget& target, float alpha);
+    void drawScreen(sf::RenderTarget& target, float alpha);
 };
 
 // Constructor definition
-Game::Game()
+Game::Game(const GameOptions& options)
     : window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), GAME_TITLE, sf::Style::Close | sf::Style::Titlebar),
-    currentLevel(0), currentQuestionIndex(0), score(0), lives(3), selectedOption(-1), showingFeedback(false),
+    frameAccumulator(0.f), levelScroll(0.f), hoveredLevelWidget(-1), selectedOption(-1), loadingPercent(-1),
+    assetReport(options.assetReport), profilePath(options.profilePath), questionBankPath(options.questionBankPath),
+    keepOldSave(false), playerId(fnv1a(options.player.data(), options.player.size())),
+    allocationCheck(options.allocationCheck), steadyFrames(0), simTick(0), recordPath(options.recordPath), replaying(false), replayNext(0),
     startButton(nullptr), exitButton(nullptr), rulesButton(nullptr),
     backToMenuFromLevelSelectButton(nullptr), backToMenuFromRulesButton(nullptr), backToMenuFromGameOverButton(nullptr)
 {
-    window.setFramerateLimit(60);
-    srand(static_cast<unsigned>(time(nullptr)));
+    lastFrameState = { GameLogic::MENU, -1, -1, false };
+    // Simulation runs at a fixed step, so render as fast as the display allows;
+    // benchmarks render offscreen and measure unthrottled frames
+    window.setVerticalSyncEnabled(!options.benchmark);
+    if (options.benchmark)
+        window.setVisible(false);
+    if (!profilePath.empty())
+        profiler.startRecording();
+    if (!screenCache.create(WINDOW_WIDTH, WINDOW_HEIGHT))
+        std::cerr << "Warning: render textures unavailable, static screens are redrawn every frame.\n";
+
+    // A replay restores the recorded seed and mouse position; otherwise start a new log
+    unsigned seed = options.seedGiven ? options.seed : static_cast<unsigned>(time(nullptr));
+    mousePosition = sf::Mouse::getPosition(window);
+    if (!options.replayPath.empty()) {
+        if (!inputLog.load(options.replayPath)) {
+            window.close();
+            return;
+        }
+        replaying = true;
+        seed = inputLog.header.seed;
+        mousePosition = { inputLog.header.mouseX, inputLog.header.mouseY };
+    }
+    else {
+        inputLog.header.seed = seed;
+        inputLog.header.mouseX = mousePosition.x;
+        inputLog.header.mouseY = mousePosition.y;
+    }
+    logic.seed(seed);
 
-    if (!font.loadFromFile(FONT_PATH)) {
+    font = assets.getFont(FONT_PATH);
+    if (!font) {
         std::cerr << "FATAL ERROR: Could not load font from " << FONT_PATH << "\n";
         window.close();
         return;
@@ -394,26 +3770,43 @@ Game::Game()
     float centerX = WINDOW_WIDTH / 2.f;
 
     // Initialize buttons for menu and screens
-    startButton = new Button({ 200, 60 }, { centerX, 250.f }, "Start Game", font, 30);
-    rulesButton = new Button({ 150, 60 }, { centerX, 340.f }, "Rules", font, 30);
-    exitButton = new Button({ 140, 60 }, { centerX, 430.f }, "Exit", font, 30);
-    backToMenuFromLevelSelectButton = new Button({ 180, 40 }, { 100.f, WINDOW_HEIGHT - 50.f }, "Back to Menu", font, 20);
-    backToMenuFromRulesButton = new Button({ 180, 40 }, { 100.f, WINDOW_HEIGHT - 50.f }, "Back to Menu", font, 20);
-    backToMenuFromGameOverButton = new Button({ 220, 50 }, { centerX, WINDOW_HEIGHT * 0.75f }, "Back to Menu", font, 24);
+    startButton = new Button({ 200, 60 }, { centerX, 250.f }, "Start Game", *font, 30);
+    rulesButton = new Button({ 150, 60 }, { centerX, 340.f }, "Rules", *font, 30);
+    exitButton = new Button({ 140, 60 }, { centerX, 430.f }, "Exit", *font, 30);
+    backToMenuFromLevelSelectButton = new Button({ 180, 40 }, { 100.f, WINDOW_HEIGHT - 50.f }, "Back to Menu", *font, 20);
+    backToMenuFromRulesButton = new Button({ 180, 40 }, { 100.f, WINDOW_HEIGHT - 50.f }, "Back to Menu", *font, 20);
+    backToMenuFromGameOverButton = new Button({ 220, 50 }, { centerX, WINDOW_HEIGHT * 0.75f }, "Back to Menu", *font, 24);
 
     loadResources();
-    loadLevels();
+    if (!logic.loadLevels(options.questionBankPath))
+        std::cerr << "Warning loading question bank.\n";
+    if (replaying && inputLog.header.bankChecksum != logic.bank.checksum())
+        std::cerr << "Warning: replay was recorded with a different question bank.\n";
+    inputLog.header.bankChecksum = logic.bank.checksum();
+
+    // Recordings, replays and benchmarks start from a fresh schedule and ratings and leave the
+    // saved ones alone, so a replay asks the same questions as the recorded session
+    if (options.recordPath.empty() && options.replayPath.empty() && !options.benchmark) {
+        progressPath = options.progressPath;
+        uint32_t savedSequence = 0;
+        keepOldSave = !loadSaveGame(progressPath, logic, savedSequence) && std::ifstream(progressPath).good();
+        loadJournal(options.journalPath, savedSequence);
+    }
 
+    prewarmGlyphs();
     setupCommonText();
+    setupLoadingBar();
     setupMenu();
     setupLevelSelection();
     setupRules();
     setupQuestionDisplay();
     setupGameOver();
 
-    if (backgroundMusic.openFromFile(MUSIC_PATH)) {
+    voices.setCategoryVolume(VoicePool::SOUND_EFFECTS, EFFECTS_VOLUME);
+    voices.setCategoryVolume(VoicePool::SOUND_FEEDBACK, FEEDBACK_VOLUME);
+    if (!options.benchmark && backgroundMusic.openFromFile(MUSIC_PATH)) {
         backgroundMusic.setLoop(true);
-        backgroundMusic.setVolume(40.f);
+        backgroundMusic.setVolume(100.f * MUSIC_VOLUME);
         backgroundMusic.play();
     }
 }
@@ -424,105 +3817,71 @@ Game::~Game() {
     delete rulesButton;
     delete exitButton;
     delete backToMenuFromLevelSelectButton;
-    delete backToMenuFromRulesButton;
-    delete backToMenuFromGameOverButton;
-}
-
-// Load game resources
-void Game::loadResources() {
-    if (!correctSoundBuffer.loadFromFile(CORRECT_SOUND_PATH))
-        std::cerr << "Warning loading correct sound.\n";
-    else
-        correctSound.setBuffer(correctSoundBuffer);
-
-    if (!incorrectSoundBuffer.loadFromFile(INCORRECT_SOUND_PATH))
-        std::cerr << "Warning loading incorrect sound.\n";
-    else
-        incorrectSound.setBuffer(incorrectSoundBuffer);
-
-    if (!backgroundTexture.loadFromFile(BACKGROUND_TEXTURE_PATH))
-        std::cerr << "Warning loading background texture.\n";
-    else {
-        backgroundSprite.setTexture(backgroundTexture);
-        backgroundSprite.setScale(
-            float(WINDOW_WIDTH) / backgroundTexture.getSize().x,
-            float(WINDOW_HEIGHT) / backgroundTexture.getSize().y);
-    }
-
-    if (!homeImageTexture.loadFromFile(HOME_IMAGE_PATH)) {
-        std::cerr << "Warning loading home page image.\n";
-    }
-    else {
-        homeImageSprite.setTexture(homeImageTexture);
-        float scaleX = 300.f / homeImageTexture.getSize().x;
-        float scaleY = 150.f / homeImageTexture.getSize().y;
-        float scale = std::min(scaleX, scaleY);
-        homeImageSprite.setScale(scale, scale);
-        homeImageSprite.setPosition(WINDOW_WIDTH / 2.f - (homeImageTexture.getSize().x * scale) / 2.f, 180.f);
-    }
-
-    if (!explosion.loadTexture(EXPLOSION_TEXTURE_PATH, 5))
-        std::cerr << "Warning loading explosion texture.\n";
-
-    if (!shooter.loadTextures(SHOOTER_TEXTURE_PATH, BULLET_TEXTURE_PATH))
-        std::cerr << "Warning loading shooter or bullet textures.\n";
+    delete backToMenuFromRulesButton;
+    delete backToMenuFromGameOverButton;
 }
 
-// Load levels and questions, initialize unlock vector
-void Game::loadLevels() {
-    levels.clear();
-
-    levels.emplace_back("Lesson: Introduction\nto Variables", std::vector<Question>{
-        Question("What is a variable?", { "A place to store data", "A type of operator", "A data structure", "None of the above" }, 0),
-            Question("Which of the following is an integer?", { "5", "5.5", "Hello", "True" }, 0),
-            Question("Which is not a valid variable type in C++?", { "int", "float", "char", "number" }, 3),
-            Question("Which of the following is used for declaring a variable?", { "int", "printf", "cin", "return" }, 0),
-            Question("What is the default value of an uninitialized int in C++?", { "0", "undefined", "garbage", "null" }, 2)
+// Start loading game resources in the background; each one is hooked up as it arrives
+void Game::loadResources() {
+    correctSoundBuffer = assets.loadSoundBufferAsync(CORRECT_SOUND_PATH, [this](bool ok) {
+        if (!ok)
+            std::cerr << "Warning loading correct sound.\n";
     });
 
-    levels.emplace_back("Lesson: Functions\nand Default Args", std::vector<Question>{
-        Question("What is a function?", { "A block of code that performs a specific task", "A variable", "A loop", "None of the above" }, 0),
-            Question("Can functions have default arguments?", { "Yes", "No", "Only if they are pointers", "None of the above" }, 0),
-            Question("How do you declare a function in C++?", { "void myFunction()", "function myFunction()", "def myFunction()", "None of the above" }, 0),
-            Question("What does 'return' do in a function?", { "Exits the function and optionally returns a value", "Executes a loop", "Ends the program", "None of the above" }, 0),
-            Question("What is a function prototype?", { "A declaration of a function before its actual definition", "A loop", "A variable", "None of the above" }, 0)
+    incorrectSoundBuffer = assets.loadSoundBufferAsync(INCORRECT_SOUND_PATH, [this](bool ok) {
+        if (!ok)
+            std::cerr << "Warning loading incorrect sound.\n";
     });
 
-    levels.emplace_back("Lesson: Object-Oriented\nProgramming Basics", std::vector<Question>{
-        Question("What is polymorphism?", { "Ability to change shape", "Ability to inherit", "Ability to access memory", "None of the above" }, 0),
-            Question("What is a class in C++?", { "A template for objects", "A function", "A variable", "None of the above" }, 0),
-            Question("What does inheritance allow?", { "A class to inherit properties from another class", "A function to return values", "A variable to store data", "None of the above" }, 0),
-            Question("What is a constructor in C++?", { "A special function to initialize objects", "A function to destroy objects", "A function to add data", "None of the above" }, 0),
-            Question("What is the difference between a constructor and a destructor?", { "A constructor initializes, a destructor cleans up", "A constructor is optional", "A destructor is used for loops", "None of the above" }, 0)
+    backgroundTexture = assets.loadTextureAsync(BACKGROUND_TEXTURE_PATH, [this](bool ok) {
+        if (!ok)
+            std::cerr << "Warning loading background texture.\n";
+        else {
+            backgroundSprite.setTexture(*backgroundTexture, true);
+            screenCache.invalidate();
+            backgroundSprite.setScale(
+                float(WINDOW_WIDTH) / backgroundTexture->getSize().x,
+                float(WINDOW_HEIGHT) / backgroundTexture->getSize().y);
+        }
     });
 
-    levels.emplace_back("Lesson: Loops\nand Iteration", std::vector<Question>{
-        Question("What is a 'for' loop?", { "A control flow statement for iteration", "An if statement", "A function", "None of the above" }, 0),
-            Question("What does 'break' do in a loop?", { "Exit the loop immediately", "Continue to next iteration", "Start a new loop", "None of the above" }, 0),
-            Question("What is the difference between 'while' and 'do-while' loops?", { "'do-while' executes at least once", "'while' executes at least once", "No difference", "None of the above" }, 0),
-            Question("What keyword is used to skip current iteration?", { "continue", "break", "skip", "pass" }, 0),
-            Question("Can loops be nested?", { "Yes", "No", "Sometimes", "None of the above" }, 0)
-    });
+    // Small sprites share one atlas page instead of one texture each
+    spriteAtlas.load(assets, {
+        { "home", HOME_IMAGE_PATH },
+        { "explosion", EXPLOSION_TEXTURE_PATH },
+        { "shooter", SHOOTER_TEXTURE_PATH },
+        { "bullet", BULLET_TEXTURE_PATH }
+    }, [this](bool) {
+        const TextureAtlas::Region* home = spriteAtlas.find("home");
+        if (!home) {
+            std::cerr << "Warning loading home page image.\n";
+        }
+        else {
+            homeImageSprite.setTexture(*home->texture);
+            homeImageSprite.setTextureRect(home->rect);
+            float scaleX = 300.f / home->rect.width;
+            float scaleY = 150.f / home->rect.height;
+            float scale = std::min(scaleX, scaleY);
+            homeImageSprite.setScale(scale, scale);
+            homeImageSprite.setPosition(WINDOW_WIDTH / 2.f - (home->rect.width * scale) / 2.f, 180.f);
+            screenCache.invalidate();
+        }
 
-    levels.emplace_back("Lesson: Arrays\nand Vectors", std::vector<Question>{
-        Question("What is an array?", { "A collection of elements", "A variable", "A function", "None of the above" }, 0),
-            Question("What is 'std::vector'?", { "A dynamic array", "A fixed array", "A linked list", "None of the above" }, 0),
-            Question("How do you access array elements?", { "Using indices starting at zero", "Using keys", "By value", "None of the above" }, 0),
-            Question("Can vectors resize dynamically?", { "Yes", "No", "Only in C++11", "None of the above" }, 0),
-            Question("What header is needed for std::vector?", { "#include <vector>", "#include <array>", "#include <list>", "None of the above" }, 0)
-    });
+        const TextureAtlas::Region* boom = spriteAtlas.find("explosion");
+        if (!boom)
+            std::cerr << "Warning loading explosion texture.\n";
+        else
+            explosion.setSpriteSheet(*boom, 5);
 
-    levels.emplace_back("Lesson: Pointers\nand Memory", std::vector<Question>{
-        Question("What is a pointer?", { "A variable storing memory address", "An integer", "A function", "None of the above" }, 0),
-            Question("What does 'nullptr' represent?", { "Null pointer", "Zero", "Uninitialized pointer", "None of the above" }, 0),
-            Question("What operator dereferences a pointer?", { "*", "&", "->", "None of the above" }, 0),
-            Question("What does 'new' keyword do?", { "Allocates memory", "Deletes memory", "Creates pointer", "None of the above" }, 0),
-            Question("What is a smart pointer?", { "Manages lifetime of dynamically allocated memory", "Regular pointer", "Array", "None of the above" }, 0)
+        const TextureAtlas::Region* ship = spriteAtlas.find("shooter");
+        const TextureAtlas::Region* bullet = spriteAtlas.find("bullet");
+        if (!ship || !bullet)
+            std::cerr << "Warning loading shooter or bullet textures.\n";
+        else {
+            shooter.setSprites(*ship, *bullet);
+            spriteBatch.reserve(*bullet->texture, MAX_BULLETS + 2); // bullets, shooter and explosion
+        }
     });
-
-    levelUnlocked.assign(levels.size(), false);
-    if (!levelUnlocked.empty())
-        levelUnlocked[0] = true;
 }
 
 // Setup fonts, texts and UI components common to all screens
@@ -533,31 +3892,86 @@ void Game::setupCommonText() {
     scoreBox.setOutlineThickness(3.f);
     scoreBox.setPosition(WINDOW_WIDTH - 140.f, 10.f);
 
-    scoreTextBox.setFont(font);
+    scoreTextBox.setFont(*font);
     scoreTextBox.setCharacterSize(22);
     scoreTextBox.setFillColor(sf::Color::Cyan);
     scoreTextBox.setPosition(scoreBox.getPosition().x + 10.f, scoreBox.getPosition().y + 5.f);
 
-    livesText.setFont(font);
+    livesText.setFont(*font);
     livesText.setCharacterSize(24);
     livesText.setFillColor(sf::Color::White);
     livesText.setPosition(WINDOW_WIDTH - 120, 60);
 
-    levelProgressText.setFont(font);
+    levelProgressText.setFont(*font);
     levelProgressText.setCharacterSize(20);
     levelProgressText.setFillColor(sf::Color(200, 200, 200));
 
-    feedbackText.setFont(font);
+    feedbackText.setFont(*font);
     feedbackText.setCharacterSize(48);
 
-    escapeHintText.setFont(font);
+    escapeHintText.setFont(*font);
     escapeHintText.setCharacterSize(14);
     escapeHintText.setFillColor(sf::Color(180, 180, 180));
 }
 
+// Set the Esc hint for the current screen; nothing is rebuilt if it is already showing this text
+void Game::setEscapeHint(const std::string& hint, sf::Vector2f position, float anchorX) {
+    escapeHintText.setString(hint);
+    escapeHintText.setAnchor(anchorX, 0.5f);
+    escapeHintText.setPosition(position);
+}
+
+// Setup the progress bar shown along the bottom of the menu while assets load
+void Game::setupLoadingBar() {
+    loadingBarBack.setSize({ 300.f, 12.f });
+    loadingBarBack.setFillColor(sf::Color(30, 30, 70, 200));
+    loadingBarBack.setOutlineColor(sf::Color::Cyan);
+    loadingBarBack.setOutlineThickness(2.f);
+    loadingBarBack.setPosition(WINDOW_WIDTH / 2.f - 150.f, WINDOW_HEIGHT - 60.f);
+
+    loadingBarFill.setSize({ 0.f, 12.f });
+    loadingBarFill.setFillColor(sf::Color::Cyan);
+    loadingBarFill.setPosition(loadingBarBack.getPosition());
+
+    loadingText.setFont(*font);
+    loadingText.setCharacterSize(14);
+    loadingText.setFillColor(sf::Color(180, 180, 180));
+    loadingText.setPosition(loadingBarBack.getPosition().x, loadingBarBack.getPosition().y - 22.f);
+}
+
+// Queue the glyphs of the question bank and of the UI text at every UI character size;
+// run() loads them during the loading screen
+void Game::prewarmGlyphs() {
+    glyphWarmer.clearCharacters();
+    for (char c = 32; c < 127; ++c) // UI labels, scores and hints are plain ASCII
+        glyphWarmer.addCharacters(&c, 1);
+    TextView bankText = logic.bank.allText();
+    glyphWarmer.addCharacters(bankText.data, bankText.size);
+    glyphWarmer.start(*font, UI_TEXT_SIZES, sizeof(UI_TEXT_SIZES) / sizeof(UI_TEXT_SIZES[0]));
+}
+
+// True while assets are still arriving or glyphs are still being prewarmed
+bool Game::isLoading() const {
+    return assets.isLoading() || !glyphWarmer.done();
+}
+
+// Resize the progress bar; the label is only rebuilt when the percentage changes
+void Game::updateLoadingBar() {
+    float progress = (assets.loadingProgress() + glyphWarmer.progress()) / 2.f;
+    loadingBarFill.setSize({ loadingBarBack.getSize().x * progress, loadingBarBack.getSize().y });
+    int percent = static_cast<int>(progress * 100.f);
+    if (percent != loadingPercent) {
+        loadingPercent = percent;
+        char label[32];
+        std::snprintf(label, sizeof(label), "Loading assets... %d%%", percent);
+        loadingText.setString(label);
+    }
+}
+
 // Setup main menu with centered buttons
 void Game::setupMenu() {
-    gameNameText.setFont(font);
+    screenCache.invalidate();
+    gameNameText.setFont(*font);
     gameNameText.setString(GAME_TITLE);
     gameNameText.setCharacterSize(60);
     gameNameText.setFillColor(sf::Color::Cyan);
@@ -565,19 +3979,16 @@ void Game::setupMenu() {
     gameNameText.setOrigin(titleBounds.left + titleBounds.width / 2.f, titleBounds.top + titleBounds.height / 2.f);
     gameNameText.setPosition(WINDOW_WIDTH / 2.f, 120);
 
-    startButton->updateColor({ -1, -1 });
-    rulesButton->updateColor({ -1, -1 });
-    exitButton->updateColor({ -1, -1 });
+    startButton->updateHover(mousePosition);
+    rulesButton->updateHover(mousePosition);
+    exitButton->updateHover(mousePosition);
 
-    escapeHintText.setString("(Esc to quit)");
-    sf::FloatRect hintBounds = escapeHintText.getLocalBounds();
-    escapeHintText.setOrigin(hintBounds.left + hintBounds.width / 2.f, hintBounds.top + hintBounds.height / 2.f);
-    escapeHintText.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT - 20.f);
+    setEscapeHint("(Esc to quit)", { WINDOW_WIDTH / 2.f, WINDOW_HEIGHT - 20.f }, 0.5f);
 }
 
 // Setup level selection screen with unlock logic and big multi-line buttons
 void Game::setupLevelSelection() {
-    levelSelectText.setFont(font);
+    levelSelectText.setFont(*font);
     levelSelectText.setString("Select Level");
     levelSelectText.setCharacterSize(40);
     levelSelectText.setFillColor(sf::Color::Yellow);
@@ -586,43 +3997,30 @@ void Game::setupLevelSelection() {
     levelSelectText.setOrigin(lsBounds.left + lsBounds.width / 2.f, lsBounds.top + lsBounds.height / 2.f);
     levelSelectText.setPosition(WINDOW_WIDTH / 2.f, 40);  // Moved upward from 60 to 40 for spacing
 
-    levelButtons.clear();
-
-    const float buttonWidth = 700.f;
-    const float totalAvailableHeight = WINDOW_HEIGHT - 150.f;
-    const float verticalSpacing = 12.f;
-    float buttonHeight = (totalAvailableHeight - (verticalSpacing * (levels.size() - 1))) / levels.size();
-    if (buttonHeight > 100.f)
-        buttonHeight = 100.f;
-
-    const float startX = WINDOW_WIDTH / 2.f;
-    const float startY = 100.f; // Adjusted downward slightly for button start to fit after header
-
-    for (size_t i = 0; i < levels.size(); ++i) {
-        float posY = startY + static_cast<float>(i) * (buttonHeight + verticalSpacing);
-        levelButtons.emplace_back(
-            sf::Vector2f(buttonWidth, buttonHeight),
-            sf::Vector2f(startX, posY),
-            levels[i].levelName,
-            font,
-            24
-        );
-        levelButtons.back().setEnabled(i < levelUnlocked.size() ? levelUnlocked[i] : false);
+    // Enough pooled buttons to cover the list area plus one partly scrolled-in row
+    const float listHeight = LEVEL_LIST_BOTTOM - LEVEL_LIST_TOP;
+    const size_t poolSize = static_cast<size_t>(listHeight / (LEVEL_BUTTON_HEIGHT + LEVEL_BUTTON_SPACING)) + 2;
+    if (levelButtons.empty()) {
+        levelButtons.reserve(poolSize);
+        for (size_t i = 0; i < poolSize; ++i)
+            levelButtons.emplace_back(sf::Vector2f(700.f, LEVEL_BUTTON_HEIGHT), sf::Vector2f(WINDOW_WIDTH / 2.f, 0.f), "", *font, 24);
+        levelListView.reset(sf::FloatRect(0.f, LEVEL_LIST_TOP, static_cast<float>(WINDOW_WIDTH), listHeight));
+        levelListView.setViewport(sf::FloatRect(0.f, LEVEL_LIST_TOP / WINDOW_HEIGHT, 1.f, listHeight / WINDOW_HEIGHT));
+        levelScrollBar.setFillColor(sf::Color(120, 120, 220, 160));
     }
 
-    backToMenuFromLevelSelectButton->updateColor({ -1, -1 });
+    // Unlocks may have changed since the list was last shown, so relabel every row
+    levelButtonLevel.assign(levelButtons.size(), -1);
+    scrollLevelList(0.f);
 
     sf::FloatRect backBounds = backToMenuFromLevelSelectButton->rect.getGlobalBounds();
-    escapeHintText.setString("(Esc to go back)");
-    escapeHintText.setCharacterSize(14);
-    escapeHintText.setFillColor(sf::Color(180, 180, 180));
-    escapeHintText.setOrigin(0, escapeHintText.getLocalBounds().height / 2.f);
-    escapeHintText.setPosition(backBounds.left + backBounds.width + 10.f, backBounds.top + backBounds.height / 2.f);
+    setEscapeHint("(Esc to go back)", { backBounds.left + backBounds.width + 10.f, backBounds.top + backBounds.height / 2.f }, 0.f);
 }
 
 // Setup rules screen with semi-transparent background behind the rules text only
 void Game::setupRules() {
-    rulesTitleText.setFont(font);
+    screenCache.invalidate();
+    rulesTitleText.setFont(*font);
     rulesTitleText.setString("Game Rules");
     rulesTitleText.setCharacterSize(40);
     rulesTitleText.setFillColor(sf::Color::Yellow);
@@ -630,14 +4028,15 @@ void Game::setupRules() {
     rulesTitleText.setOrigin(rtBounds.left + rtBounds.width / 2.f, rtBounds.top + rtBounds.height / 2.f);
     rulesTitleText.setPosition(WINDOW_WIDTH / 2.f, 100);
 
-    rulesBodyText.setFont(font);
+    rulesBodyText.setFont(*font);
     rulesBodyText.setString(
         "Welcome to the Cosmic Quiz Challenge!\n\n"
         "- Select a level to begin.\n"
         "- Answer multiple-choice questions about C++ programming.\n"
         "- Click on the answer you think is correct.\n"
         "- You start with 3 lives. An incorrect answer costs one life.\n"
-        "- Complete all questions in a level to unlock the next one.\n"
+        "- Each run asks " + std::to_string(ADAPTIVE_MIN_QUESTIONS) + " to " + std::to_string(ADAPTIVE_MAX_QUESTIONS)
+        + " questions picked for your skill;\n  finish it with lives left to unlock the next level.\n"
         "- Your score increases with each correct answer.\n"
         "- Have fun!\n\n"
         "Good luck, Cadet!"
@@ -652,37 +4051,35 @@ void Game::setupRules() {
     rulesBackgroundRect.setFillColor(sf::Color(0, 0, 0, 180)); // semi-transparent black
     rulesBackgroundRect.setPosition(rulesBodyText.getPosition().x - 20.f, rulesBodyText.getPosition().y - 10.f);
 
-    backToMenuFromRulesButton->updateColor({ -1, -1 });
+    backToMenuFromRulesButton->updateHover(mousePosition);
 
     sf::FloatRect backBounds = backToMenuFromRulesButton->rect.getGlobalBounds();
-    escapeHintText.setString("(Esc to go back)");
-    escapeHintText.setCharacterSize(14);
-    escapeHintText.setFillColor(sf::Color(180, 180, 180));
-    escapeHintText.setOrigin(0, escapeHintText.getLocalBounds().height / 2.f);
-    escapeHintText.setPosition(backBounds.left + backBounds.width + 10.f, backBounds.top + backBounds.height / 2.f);
+    setEscapeHint("(Esc to go back)", { backBounds.left + backBounds.width + 10.f, backBounds.top + backBounds.height / 2.f }, 0.f);
 }
 
 // Setup question display for in-game screen
 void Game::setupQuestionDisplay() {
-    questionText.setFont(font);
+    questionText.setFont(*font);
     questionText.setCharacterSize(28);
     questionText.setFillColor(sf::Color::White);
 
-    optionTexts.resize(4);
-    optionBoxes.resize(4);
+    optionTexts.resize(MAX_OPTIONS);
+    optionBoxes.resize(MAX_OPTIONS);
+    optionHitGrid.clear();
     float startY = 180.f;
     float spacing = 80.f;
     float optionWidth = WINDOW_WIDTH - 100.f;
     float optionHeight = 60.f;
 
-    for (int i = 0; i < 4; i++) {
+    for (int i = 0; i < MAX_OPTIONS; i++) {
         optionBoxes[i].setSize({ optionWidth, optionHeight });
         optionBoxes[i].setFillColor(sf::Color(90, 90, 150));
         optionBoxes[i].setOutlineColor(sf::Color(160, 160, 255));
         optionBoxes[i].setOutlineThickness(3.f);
         optionBoxes[i].setPosition(50.f, startY + i * spacing);
+        optionHitGrid.add(i, optionBoxes[i].getGlobalBounds());
 
-        optionTexts[i].setFont(font);
+        optionTexts[i].setFont(*font);
         optionTexts[i].setCharacterSize(22);
         optionTexts[i].setFillColor(sf::Color::White);
     }
@@ -696,7 +4093,8 @@ void Game::setupQuestionDisplay() {
 
 // Setup game over screen elements
 void Game::setupGameOver() {
-    gameOverText.setFont(font);
+    screenCache.invalidate();
+    gameOverText.setFont(*font);
     gameOverText.setString("GAME OVER");
     gameOverText.setCharacterSize(72);
     gameOverText.setFillColor(sf::Color::Red);
@@ -704,41 +4102,43 @@ void Game::setupGameOver() {
     gameOverText.setOrigin(goBounds.left + goBounds.width / 2.f, goBounds.top + goBounds.height / 2.f);
     gameOverText.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 3.f);
 
-    finalScoreText.setFont(font);
-    finalScoreText.setString("Final Score: " + std::to_string(score));
+    finalScoreText.setFont(*font);
+    char label[32];
+    std::snprintf(label, sizeof(label), "Final Score: %d", logic.score);
+    finalScoreText.setString(label);
     finalScoreText.setCharacterSize(36);
     finalScoreText.setFillColor(sf::Color::White);
-    sf::FloatRect fsBounds = finalScoreText.getLocalBounds();
-    finalScoreText.setOrigin(fsBounds.left + fsBounds.width / 2.f, fsBounds.top + fsBounds.height / 2.f);
+    finalScoreText.setAnchor(0.5f, 0.5f);
     finalScoreText.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f);
 
-    backToMenuFromGameOverButton->updateColor({ -1, -1 });
+    backToMenuFromGameOverButton->updateHover(mousePosition);
 
-    sf::FloatRect backBounds = backToMenuFromGameOverButton->rect.getGlobalBounds();
-    escapeHintText.setString("(Esc to go back)");
-    escapeHintText.setCharacterSize(14);
-    escapeHintText.setFillColor(sf::Color(180, 180, 180));
-    escapeHintText.setOrigin(0, escapeHintText.getLocalBounds().height / 2.f);
-    escapeHintText.setPosition(backBounds.left + backBounds.width + 10.f, backBounds.top + backBounds.height / 2.f);
+    setEscapeHint("(Esc to go back)", { 10.f, WINDOW_HEIGHT - 20.f }, 0.f);
 }
 
 // Load question data for current level/question
 void Game::loadQuestion(int levelIdx, int questionIdx) {
-    if ((unsigned)levelIdx >= levels.size() || (unsigned)questionIdx >= levels[levelIdx].questions.size()) {
-        gameState = LEVEL_SELECTION;
+    const Question* current = logic.loadQuestion(levelIdx, questionIdx);
+    if (!current) {
         setupLevelSelection();
         return;
     }
-    const Question& q = levels[levelIdx].questions[questionIdx];
-    questionText.setString("Q" + std::to_string(questionIdx + 1) + ": " + q.questionText);
+    const Question& q = *current;
+    const QuestionBank& bank = logic.bank;
+    char label[48];
+    std::snprintf(label, sizeof(label), "Q%d: ", logic.questionsAsked + 1); // position in the run, not in the bank
+    TextView body = bank.questionText(q);
+    textScratch.assign(label).append(body.data, body.size);
+    questionText.setString(textScratch);
     sf::FloatRect qBounds = questionText.getLocalBounds();
     questionText.setOrigin(qBounds.left + qBounds.width / 2.f, qBounds.top + qBounds.height / 2.f);
     questionText.setPosition(WINDOW_WIDTH / 2.f, 100.f);
 
-    for (int i = 0; i < 4; i++) {
-        if ((unsigned)i < q.options.size()) {
-            char optionLabel = 'A' + i;
-            optionTexts[i].setString(std::string(1, optionLabel) + ") " + q.options[i]);
+    for (int i = 0; i < MAX_OPTIONS; i++) {
+        if (i < q.optionCount) {
+            TextView option = bank.optionText(q, i);
+            textScratch.assign(1, static_cast<char>('A' + i)).append(") ").append(option.data, option.size);
+            optionTexts[i].setString(textScratch);
         }
         else optionTexts[i].setString("");
         sf::FloatRect optBounds = optionTexts[i].getLocalBounds();
@@ -746,70 +4146,154 @@ void Game::loadQuestion(int levelIdx, int questionIdx) {
         optionTexts[i].setPosition(optionBoxes[i].getPosition().x + 20.f, optionBoxes[i].getPosition().y + optionBoxes[i].getSize().y / 2.f);
     }
     selectedOption = -1;
-    showingFeedback = false;
+    updateSelectionIndicator();
+    updateHover(); // the mouse may already rest on an answer
 
-    levelProgressText.setString("Question " + std::to_string(questionIdx + 1) + " / " + std::to_string(levels[levelIdx].questions.size()));
-    sf::FloatRect progBounds = levelProgressText.getLocalBounds();
-    levelProgressText.setOrigin(progBounds.left + progBounds.width / 2.f, progBounds.top + progBounds.height / 2.f);
+    std::snprintf(label, sizeof(label), "Question %d  -  Skill %d", logic.questionsAsked + 1, static_cast<int>(logic.difficulty.playerRating));
+    levelProgressText.setString(label);
+    levelProgressText.setAnchor(0.5f, 0.5f);
     levelProgressText.setPosition(WINDOW_WIDTH / 2.f, 35.f);
+
+    setEscapeHint("(Esc to go back)", { 10.f, WINDOW_HEIGHT - 20.f }, 0.f);
+}
+
+// Hand the player's progress to the background save writer
+void Game::saveProgress() {
+    if (progressPath.empty())
+        return;
+    // A save for another bank, or a damaged one, is kept rather than overwritten
+    if (keepOldSave) {
+        keepOldSave = false;
+        if (replaceFile(progressPath, progressPath + ".bak"))
+            std::cerr << "Warning: kept the save game that couldn't be loaded as " << progressPath << ".bak\n";
+        else {
+            std::cerr << "Error moving save game aside, progress won't be saved: " << progressPath << std::endl;
+            progressPath.clear();
+            return;
+        }
+    }
+    uint32_t sequence = journal.lastSequence();
+    encodeSaveGame(logic, sequence, saveBuffer);
+    if (!journal.isOpen()) {
+        saveWriter.submit(progressPath, saveBuffer);
+        return;
+    }
+    AnswerJournal* answers = &journal;
+    saveWriter.submit(progressPath, saveBuffer, [answers, sequence] { answers->snapshotWritten(sequence); });
+}
+
+// Open the answer journal and replay the answers made after the save game was written
+void Game::loadJournal(const std::string& path, uint32_t savedSequence) {
+    std::vector<JournalRecord> replay;
+    if (!journal.open(path, logic.bank.checksum(), savedSequence, replay))
+        return;
+    for (const JournalRecord& r : replay)
+        logic.replayAnswer(r.questionId, r.correct != 0, r.latencyMs);
 }
 
 // Update displayed score text
 void Game::updateScoreText() {
-    scoreTextBox.setString("Score: " + std::to_string(score));
+    char label[32];
+    std::snprintf(label, sizeof(label), "Score: %d", logic.score);
+    scoreTextBox.setString(label);
 }
 
 // Update displayed lives text
 void Game::updateLivesText() {
-    livesText.setString("Lives: " + std::to_string(lives));
+    char label[32];
+    std::snprintf(label, sizeof(label), "Lives: %d", logic.lives);
+    livesText.setString(label);
 }
 
 // Process SFML events
 void Game::processEvents() {
     sf::Event event;
-    while (window.pollEvent(event)) {
-        if (event.type == sf::Event::Closed)
-            window.close();
+    while (window.pollEvent(event))
+        dispatchEvent(event);
+    if (replaying)
+        feedReplay();
+}
 
-        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
-            if (gameState == IN_GAME || gameState == LEVEL_SELECTION || gameState == RULES || gameState == GAME_OVER) {
-                gameState = MENU;
-                setupMenu();
-                if (backgroundMusic.getStatus() == sf::Music::Paused)
-                    backgroundMusic.play();
-                return;
-            }
-            else if (gameState == MENU) {
-                window.close();
-            }
-        }
+// Record a live event and handle it. During a replay live input is ignored,
+// apart from closing the window and toggling the profiler overlay.
+void Game::dispatchEvent(const sf::Event& event) {
+    if (replaying) {
+        if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3))
+            handleEvent(event);
+        return;
+    }
+    if (!recordPath.empty())
+        inputLog.record(simTick, event);
+    handleEvent(event);
+}
+
+// Handle every recorded event due by the current tick; ends the replay after the last tick
+void Game::feedReplay() {
+    const std::vector<InputLog::Record>& records = inputLog.records;
+    while (replayNext < records.size() && records[replayNext].tick <= simTick)
+        handleEvent(InputLog::toEvent(records[replayNext++]));
+
+    if (replayNext == records.size() && simTick >= inputLog.header.endTick && window.isOpen()) {
+        std::cout << "Replay finished at tick " << simTick << ": state=" << logic.gameState
+            << ", score=" << logic.score << ", lives=" << logic.lives << std::endl;
+        window.close();
+    }
+}
+
+// React to a single window event
+void Game::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::Closed)
+        window.close();
 
-        switch (gameState) {
-        case MENU: processMenuEvents(event); break;
-        case LEVEL_SELECTION: processLevelSelectionEvents(event); break;
-        case RULES: processRulesEvents(event); break;
-        case IN_GAME: if (!showingFeedback) processInGameEvents(event); break;
-        case GAME_OVER: processGameOverEvents(event); break;
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+        profiler.toggleOverlay();
+
+    // Hover highlights only change when the mouse does
+    if (event.type == sf::Event::MouseMoved) {
+        mousePosition = { event.mouseMove.x, event.mouseMove.y };
+        updateHover();
+    }
+    else if (event.type == sf::Event::MouseButtonPressed) {
+        mousePosition = { event.mouseButton.x, event.mouseButton.y };
+        updateHover();
+    }
+
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        GameLogic::GameState state = logic.gameState;
+        if (state == GameLogic::IN_GAME || state == GameLogic::LEVEL_SELECTION || state == GameLogic::RULES || state == GameLogic::GAME_OVER) {
+            voices.stopAll(); // don't let a run's effects carry over into the menu
+            logic.returnToMenu();
+            setupMenu();
+            if (backgroundMusic.getStatus() == sf::Music::Paused)
+                backgroundMusic.play();
+            return;
+        }
+        else if (state == GameLogic::MENU) {
+            window.close();
         }
     }
+
+    switch (logic.gameState) {
+    case GameLogic::MENU: processMenuEvents(event); break;
+    case GameLogic::LEVEL_SELECTION: processLevelSelectionEvents(event); break;
+    case GameLogic::RULES: processRulesEvents(event); break;
+    case GameLogic::IN_GAME: if (!logic.showingFeedback) processInGameEvents(event); break;
+    case GameLogic::GAME_OVER: processGameOverEvents(event); break;
+    }
 }
 
 // Process menu events (buttons click)
 void Game::processMenuEvents(const sf::Event& event) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    startButton->updateColor(mousePos);
-    rulesButton->updateColor(mousePos);
-    exitButton->updateColor(mousePos);
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-        if (startButton->isMouseOver(mousePos)) {
-            gameState = LEVEL_SELECTION;
+        if (startButton->isMouseOver(mousePosition)) {
+            logic.openLevelSelection();
             setupLevelSelection();
         }
-        else if (rulesButton->isMouseOver(mousePos)) {
-            gameState = RULES;
+        else if (rulesButton->isMouseOver(mousePosition)) {
+            logic.openRules();
             setupRules();
         }
-        else if (exitButton->isMouseOver(mousePos)) {
+        else if (exitButton->isMouseOver(mousePosition)) {
             window.close();
         }
     }
@@ -817,25 +4301,28 @@ void Game::processMenuEvents(const sf::Event& event) {
 
 // Level selection screen click handling
 void Game::processLevelSelectionEvents(const sf::Event& event) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    for (auto& btn : levelButtons) btn.updateColor(mousePos);
-    backToMenuFromLevelSelectButton->updateColor(mousePos);
+    if (event.type == sf::Event::MouseWheelScrolled)
+        scrollLevelList(-event.mouseWheelScroll.delta * LEVEL_SCROLL_STEP);
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Down)
+        scrollLevelList(LEVEL_SCROLL_STEP);
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Up)
+        scrollLevelList(-LEVEL_SCROLL_STEP);
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::PageDown)
+        scrollLevelList(LEVEL_LIST_BOTTOM - LEVEL_LIST_TOP);
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::PageUp)
+        scrollLevelList(LEVEL_LIST_TOP - LEVEL_LIST_BOTTOM);
+
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-        for (size_t i = 0; i < levelButtons.size(); ++i) {
-            if (levelButtons[i].enabled && levelButtons[i].isMouseOver(mousePos)) {
-                currentLevel = static_cast<int>(i);
-                currentQuestionIndex = 0;
-                score = 0;
-                lives = 3;
-                gameState = IN_GAME;
-                loadQuestion(currentLevel, currentQuestionIndex);
+        int hit = levelHitGrid.find(sf::Vector2f(mousePosition));
+        if (hit >= 0 && static_cast<size_t>(hit) < levelButtons.size()) {
+            if (levelButtons[hit].enabled && logic.startLevel(levelButtonLevel[hit])) {
+                loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
                 updateScoreText();
                 updateLivesText();
-                return;
             }
         }
-        if (backToMenuFromLevelSelectButton->isMouseOver(mousePos)) {
-            gameState = MENU;
+        else if (hit >= 0) {
+            logic.returnToMenu();
             setupMenu();
         }
     }
@@ -843,11 +4330,9 @@ void Game::processLevelSelectionEvents(const sf::Event& event) {
 
 // Rules screen event handling
 void Game::processRulesEvents(const sf::Event& event) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    backToMenuFromRulesButton->updateColor(mousePos);
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-        if (backToMenuFromRulesButton->isMouseOver(mousePos)) {
-            gameState = MENU;
+        if (backToMenuFromRulesButton->isMouseOver(mousePosition)) {
+            logic.returnToMenu();
             setupMenu();
         }
     }
@@ -855,15 +4340,6 @@ void Game::processRulesEvents(const sf::Event& event) {
 
 // In-game events including option selection
 void Game::processInGameEvents(const sf::Event& event) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    sf::Vector2f mousePosF(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
-    selectedOption = -1;
-    for (size_t i = 0; i < optionBoxes.size(); ++i) {
-        if (optionBoxes[i].getGlobalBounds().contains(mousePosF)) {
-            selectedOption = static_cast<int>(i);
-            break;
-        }
-    }
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
         if (selectedOption != -1) {
             checkAnswer(selectedOption);
@@ -873,11 +4349,10 @@ void Game::processInGameEvents(const sf::Event& event) {
 
 // Game over event handling
 void Game::processGameOverEvents(const sf::Event& event) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    backToMenuFromGameOverButton->updateColor(mousePos);
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-        if (backToMenuFromGameOverButton->isMouseOver(mousePos)) {
-            gameState = MENU;
+        if (backToMenuFromGameOverButton->isMouseOver(mousePosition)) {
+            voices.stopAll();
+            logic.returnToMenu();
             setupMenu();
             if (backgroundMusic.getStatus() != sf::Music::Playing) {
                 backgroundMusic.play();
@@ -886,63 +4361,142 @@ void Game::processGameOverEvents(const sf::Event& event) {
     }
 }
 
-// Main update loop for animations and game state updates
-void Game::update() {
-    explosion.update();
-    shooter.update();
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-
-    switch (gameState) {
-    case MENU:
-        startButton->updateColor(mousePos);
-        rulesButton->updateColor(mousePos);
-        exitButton->updateColor(mousePos);
+// Hover state of the current screen's widgets for mousePosition. Widgets whose
+// hover state is unchanged are left alone, so this is cheap to call on every mouse event.
+void Game::updateHover() {
+    switch (logic.gameState) {
+    case GameLogic::MENU:
+        if (startButton->updateHover(mousePosition) | rulesButton->updateHover(mousePosition)
+            | exitButton->updateHover(mousePosition))
+            screenCache.invalidate();
         break;
-    case LEVEL_SELECTION:
-        for (auto& btn : levelButtons) btn.updateColor(mousePos);
-        backToMenuFromLevelSelectButton->updateColor(mousePos);
+    case GameLogic::LEVEL_SELECTION: {
+        int hit = levelHitGrid.find(sf::Vector2f(mousePosition));
+        if (hit != hoveredLevelWidget) {
+            if (hoveredLevelWidget >= 0) levelSelectionWidget(hoveredLevelWidget).setHovered(false);
+            if (hit >= 0) levelSelectionWidget(hit).setHovered(true);
+            hoveredLevelWidget = hit;
+        }
         break;
-    case RULES:
-        backToMenuFromRulesButton->updateColor(mousePos);
+    }
+    case GameLogic::RULES:
+        if (backToMenuFromRulesButton->updateHover(mousePosition))
+            screenCache.invalidate();
         break;
-    case IN_GAME:
-        if (showingFeedback) {
-            if (feedbackTimer.getElapsedTime().asSeconds() > 1.5f) {
-                showingFeedback = false;
-                // Unlock next level only if player still has lives
-                size_t uLevel = static_cast<size_t>(currentLevel);
-                if (uLevel < levels.size()) {
-                    size_t nextQ = static_cast<size_t>(currentQuestionIndex) + 1;
-                    if (nextQ < levels[uLevel].questions.size()) {
-                        currentQuestionIndex++;
-                        loadQuestion(currentLevel, currentQuestionIndex);
-                    }
-                    else {
-                        // Completed current level; unlock next only if lives > 0
-                        if (lives > 0) {
-                            size_t nextL = uLevel + 1;
-                            if (nextL < levels.size() && nextL < levelUnlocked.size()) {
-                                levelUnlocked[nextL] = true;
-                            }
-                        }
-                        gameState = LEVEL_SELECTION;
-                        setupLevelSelection();
-                        if (backgroundMusic.getStatus() == sf::Music::Paused)
-                            backgroundMusic.play();
-                    }
-                }
-                else {
-                    gameState = MENU;
-                    setupMenu();
-                }
-            }
-        }
-        else {
+    case GameLogic::IN_GAME: {
+        int hoveredOption = optionHitGrid.find(sf::Vector2f(mousePosition));
+        if (hoveredOption != selectedOption) {
+            selectedOption = hoveredOption;
             updateSelectionIndicator();
         }
         break;
-    case GAME_OVER:
-        backToMenuFromGameOverButton->updateColor(mousePos);
+    }
+    case GameLogic::GAME_OVER:
+        if (backToMenuFromGameOverButton->updateHover(mousePosition))
+            screenCache.invalidate();
+        break;
+    }
+}
+
+// Scroll the level list (positive is down), clamped to its content
+void Game::scrollLevelList(float pixels) {
+    const float pitch = LEVEL_BUTTON_HEIGHT + LEVEL_BUTTON_SPACING;
+    const float contentHeight = logic.bank.levelCount() * pitch - LEVEL_BUTTON_SPACING;
+    const float maxScroll = std::max(0.f, contentHeight - (LEVEL_LIST_BOTTOM - LEVEL_LIST_TOP));
+    levelScroll = std::max(0.f, std::min(maxScroll, levelScroll + pixels));
+    layoutLevelList();
+}
+
+// Assign pooled buttons to the rows in view and register their visible parts for hit-testing.
+// Costs O(pool size) whatever the level count; buttons keep their label while their row stays in view.
+void Game::layoutLevelList() {
+    const QuestionBank& bank = logic.bank;
+    const float pitch = LEVEL_BUTTON_HEIGHT + LEVEL_BUTTON_SPACING;
+    const int firstLevel = static_cast<int>(levelScroll / pitch);
+    const sf::FloatRect listArea(0.f, LEVEL_LIST_TOP, static_cast<float>(WINDOW_WIDTH), LEVEL_LIST_BOTTOM - LEVEL_LIST_TOP);
+
+    // Rows that stay in view keep their button; the rest are recycled for rows scrolling in
+    std::vector<int>& shown = levelButtonLevel;
+    const int poolSize = static_cast<int>(levelButtons.size());
+    for (int slot = 0; slot < poolSize; ++slot)
+        if (shown[slot] < firstLevel || shown[slot] >= firstLevel + poolSize)
+            shown[slot] = -1;
+
+    levelHitGrid.clear();
+    for (int level = firstLevel; level < firstLevel + poolSize && level < static_cast<int>(bank.levelCount()); ++level) {
+        int slot = level % poolSize; // each row maps to a fixed slot, so rows in view never collide
+        Button& button = levelButtons[slot];
+        if (shown[slot] != level) {
+            shown[slot] = level;
+            button.setLabel(bank.levelName(bank.level(level)).str());
+            button.setEnabled(logic.isLevelUnlocked(level));
+        }
+        button.setPosition({ WINDOW_WIDTH / 2.f, LEVEL_LIST_TOP + level * pitch - levelScroll + LEVEL_BUTTON_HEIGHT / 2.f });
+
+        sf::FloatRect visible;
+        if (button.bounds.intersects(listArea, visible))
+            levelHitGrid.add(slot, visible);
+    }
+    levelHitGrid.add(poolSize, backToMenuFromLevelSelectButton->bounds);
+
+    // Scroll bar along the right edge when the list doesn't fit
+    const float listHeight = listArea.height;
+    const float contentHeight = bank.levelCount() * pitch - LEVEL_BUTTON_SPACING;
+    if (contentHeight > listHeight) {
+        float barHeight = std::max(20.f, listHeight * listHeight / contentHeight);
+        float barY = LEVEL_LIST_TOP + (listHeight - barHeight) * levelScroll / (contentHeight - listHeight);
+        levelScrollBar.setSize({ 6.f, barHeight });
+        levelScrollBar.setPosition(WINDOW_WIDTH / 2.f + 360.f, barY);
+    }
+    else {
+        levelScrollBar.setSize({ 0.f, 0.f });
+    }
+
+    // Buttons moved under a resting mouse, so hover has to be recomputed
+    for (auto& button : levelButtons) button.setHovered(false);
+    backToMenuFromLevelSelectButton->setHovered(false);
+    hoveredLevelWidget = -1;
+    updateHover();
+}
+
+// Level selection widget registered in levelHitGrid under id
+Button& Game::levelSelectionWidget(int id) {
+    if (static_cast<size_t>(id) < levelButtons.size())
+        return levelButtons[id];
+    return *backToMenuFromLevelSelectButton;
+}
+
+// Profiler scope names for each state's update branch, indexed by GameLogic::GameState
+static const char* const UPDATE_STATE_SCOPES[] = {
+    "update/MENU", "update/LEVEL_SELECTION", "update/RULES", "update/IN_GAME", "update/GAME_OVER"
+};
+
+// Main update loop for animations and game state updates, run once per fixed simulation step
+void Game::update(float dt) {
+    explosion.update(dt);
+    shooter.update(dt);
+
+    FrameProfiler::Scope stateScope(profiler, UPDATE_STATE_SCOPES[logic.gameState]);
+    switch (logic.gameState) {
+    case GameLogic::IN_GAME: // times the question, then runs the feedback delay
+        switch (logic.update(dt)) {
+        case GameLogic::FEEDBACK_NEXT_QUESTION:
+            loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
+            break;
+        case GameLogic::FEEDBACK_LEVEL_COMPLETE:
+            saveProgress();
+            setupLevelSelection();
+            if (backgroundMusic.getStatus() == sf::Music::Paused)
+                backgroundMusic.play();
+            break;
+        case GameLogic::FEEDBACK_RETURN_TO_MENU:
+            setupMenu();
+            break;
+        case GameLogic::FEEDBACK_PENDING:
+            break;
+        }
+        break;
+    default: // Other screens only change in response to input
         break;
     }
 }
@@ -959,40 +4513,34 @@ void Game::updateSelectionIndicator() {
 
 // Check if selected answer is correct; update lives, score, and provide feedback
 void Game::checkAnswer(int selected) {
-    size_t uLevel = static_cast<size_t>(currentLevel);
-    size_t uQuestion = static_cast<size_t>(currentQuestionIndex);
-
-    if (uLevel >= levels.size() || uQuestion >= levels[uLevel].questions.size()) {
+    const uint32_t latencyMs = logic.questionLatencyMs();
+    GameLogic::AnswerResult result = logic.checkAnswer(selected);
+    if (result == GameLogic::ANSWER_INVALID) {
         std::cerr << "Error: Invalid indices in checkAnswer." << std::endl;
         return;
     }
+    journal.append(playerId, logic.currentQuestionId(), selected, result == GameLogic::ANSWER_CORRECT, latencyMs);
 
-    showingFeedback = true;
-    feedbackTimer.restart();
-    const Question& question = levels[uLevel].questions[uQuestion];
-
-    if (selected == question.correctOptionIndex) {
+    if (result == GameLogic::ANSWER_CORRECT) {
         feedbackText.setString("Correct!");
         feedbackText.setFillColor(sf::Color::Green);
-        score += 10;
-        correctSound.play();
+        voices.play(*correctSoundBuffer, VoicePool::SOUND_EFFECTS, VoicePool::PRIORITY_NORMAL);
         updateScoreText();
         shooter.shoot();
     }
     else {
         feedbackText.setString("Incorrect!");
         feedbackText.setFillColor(sf::Color::Red);
-        lives--;
-        incorrectSound.play();
+        voices.play(*incorrectSoundBuffer, VoicePool::SOUND_FEEDBACK, VoicePool::PRIORITY_HIGH);
         updateLivesText();
         if (static_cast<size_t>(selected) < optionBoxes.size()) {
             sf::Vector2f boxPos = optionBoxes[selected].getPosition();
             sf::Vector2f boxSize = optionBoxes[selected].getSize();
             explosion.start(boxPos + boxSize / 2.f);
         }
-        if (lives <= 0) {
+        if (result == GameLogic::ANSWER_GAME_OVER) {
             // Show game over with final score
-            gameState = GAME_OVER;
+            saveProgress();
             setupGameOver();
             if (backgroundMusic.getStatus() == sf::Music::Playing) {
                 backgroundMusic.stop();
@@ -1000,104 +4548,718 @@ void Game::checkAnswer(int selected) {
             return;
         }
     }
-    sf::FloatRect fbBounds = feedbackText.getLocalBounds();
-    feedbackText.setOrigin(fbBounds.left + fbBounds.width / 2.f, fbBounds.top + fbBounds.height / 2.f);
+    feedbackText.setAnchor(0.5f, 0.5f);
     feedbackText.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f - 50.f);
 }
 
 
-// Render all UI elements based on current game state
-void Game::render() {
-    window.clear(sf::Color(10, 10, 30));
-    window.draw(backgroundSprite);
-
-    switch (gameState) {
-    case MENU:
-        window.draw(gameNameText);
-        window.draw(homeImageSprite);
-        startButton->draw(window);
-        rulesButton->draw(window);
-        exitButton->draw(window);
+// Profiler scope names for each state's render branch, indexed by GameLogic::GameState
+static const char* const RENDER_STATE_SCOPES[] = {
+    "render/MENU", "render/LEVEL_SELECTION", "render/RULES", "render/IN_GAME", "render/GAME_OVER"
+};
 
-        escapeHintText.setString("(Esc to quit)");
-        escapeHintText.setCharacterSize(14);
-        escapeHintText.setFillColor(sf::Color(180, 180, 180));
-        {
-            sf::FloatRect hintBounds = escapeHintText.getLocalBounds();
-            escapeHintText.setOrigin(hintBounds.left + hintBounds.width / 2.f, hintBounds.top + hintBounds.height / 2.f);
-            escapeHintText.setPosition(WINDOW_WIDTH / 2.f, WINDOW_HEIGHT - 20.f);
+// Render the current screen; alpha is how far the frame lies between the last
+// simulation step and the next one. Static screens come from the screen cache,
+// which is only recomposited after it was invalidated. run() presents the frame.
+void Game::render(sf::RenderTarget& target, float alpha) {
+    FrameProfiler::Scope stateScope(profiler, RENDER_STATE_SCOPES[logic.gameState]);
+    GameLogic::GameState state = logic.gameState;
+    bool staticScreen = state == GameLogic::MENU || state == GameLogic::RULES || state == GameLogic::GAME_OVER;
+
+    if (staticScreen && screenCache.isReady()) {
+        if (screenCache.needsRedraw(state)) {
+            FrameProfiler::Scope cacheScope(profiler, "render/screenCache");
+            drawScreen(screenCache.target(), alpha);
+            screenCache.finish(state);
         }
-        window.draw(escapeHintText);
+        screenCache.draw(target);
+    }
+    else {
+        drawScreen(target, alpha);
+    }
+
+    if (state == GameLogic::MENU && isLoading()) {
+        updateLoadingBar();
+        drawCounted(target, loadingBarBack);
+        drawCounted(target, loadingBarFill);
+        drawCounted(target, loadingText);
+    }
+}
+
+// Draw every element of the current screen, background included, into target
+void Game::drawScreen(sf::RenderTarget& target, float alpha) {
+    target.clear(sf::Color(10, 10, 30));
+    drawCounted(target, backgroundSprite);
+
+    switch (logic.gameState) {
+    case GameLogic::MENU:
+        drawCounted(target, gameNameText);
+        drawCounted(target, homeImageSprite);
+        startButton->draw(target);
+        rulesButton->draw(target);
+        exitButton->draw(target);
+
+        drawCounted(target, escapeHintText);
         break;
 
-    case LEVEL_SELECTION:
-        window.draw(levelSelectText);
-        for (auto& btn : levelButtons) btn.draw(window);
-        backToMenuFromLevelSelectButton->draw(window);
-        window.draw(escapeHintText);
+    case GameLogic::LEVEL_SELECTION:
+        drawCounted(target, levelSelectText);
+        target.setView(levelListView);
+        for (size_t i = 0; i < levelButtons.size(); ++i)
+            if (levelButtonLevel[i] >= 0) levelButtons[i].draw(target);
+        target.setView(target.getDefaultView());
+        drawCounted(target, levelScrollBar);
+        backToMenuFromLevelSelectButton->draw(target);
+        drawCounted(target, escapeHintText);
         break;
 
-    case RULES:
-        window.draw(rulesTitleText);
-        window.draw(rulesBackgroundRect); // Draw background behind rules text only
-        window.draw(rulesBodyText);
-        backToMenuFromRulesButton->draw(window);
-        window.draw(escapeHintText);
+    case GameLogic::RULES:
+        drawCounted(target, rulesTitleText);
+        drawCounted(target, rulesBackgroundRect); // Draw background behind rules text only
+        drawCounted(target, rulesBodyText);
+        backToMenuFromRulesButton->draw(target);
+        drawCounted(target, escapeHintText);
         break;
 
-    case IN_GAME:
-        window.draw(questionText);
+    case GameLogic::IN_GAME:
+        drawCounted(target, questionText);
         for (size_t i = 0; i < optionBoxes.size(); ++i) {
-            window.draw(optionBoxes[i]);
-            window.draw(optionTexts[i]);
+            drawCounted(target, optionBoxes[i]);
+            drawCounted(target, optionTexts[i]);
         }
-        if (selectedOption != -1 && !showingFeedback)
-            window.draw(selectionIndicator);
+        if (selectedOption != -1 && !logic.showingFeedback)
+            drawCounted(target, selectionIndicator);
         // Draw score box and score text
-        window.draw(scoreBox);
-        window.draw(scoreTextBox);
-        window.draw(livesText);
-        window.draw(levelProgressText);
-        if (showingFeedback)
-            window.draw(feedbackText);
-        explosion.draw(window);
-        shooter.draw(window);
-
-        escapeHintText.setString("(Esc to go back)");
-        escapeHintText.setCharacterSize(14);
-        escapeHintText.setFillColor(sf::Color(180, 180, 180));
-        escapeHintText.setOrigin(0, escapeHintText.getLocalBounds().height / 2.f);
-        escapeHintText.setPosition(10.f, WINDOW_HEIGHT - 20.f);
-        window.draw(escapeHintText);
+        drawCounted(target, scoreBox);
+        drawCounted(target, scoreTextBox);
+        drawCounted(target, livesText);
+        drawCounted(target, levelProgressText);
+        if (logic.showingFeedback)
+            drawCounted(target, feedbackText);
+        explosion.draw(spriteBatch);
+        shooter.draw(spriteBatch, alpha);
+        spriteBatch.flush(target);
+        drawCounted(target, escapeHintText);
         break;
 
-    case GAME_OVER:
-        window.draw(gameOverText);
-        window.draw(finalScoreText);
-        backToMenuFromGameOverButton->draw(window);
-
-        escapeHintText.setString("(Esc to go back)");
-        escapeHintText.setCharacterSize(14);
-        escapeHintText.setFillColor(sf::Color(180, 180, 180));
-        escapeHintText.setOrigin(0, escapeHintText.getLocalBounds().height / 2.f);
-        escapeHintText.setPosition(10.f, WINDOW_HEIGHT - 20.f);
-        window.draw(escapeHintText);
+    case GameLogic::GAME_OVER:
+        drawCounted(target, gameOverText);
+        drawCounted(target, finalScoreText);
+        backToMenuFromGameOverButton->draw(target);
+        drawCounted(target, escapeHintText);
         break;
     }
-    window.display();
 }
 
 // Main run loop
+// True when the next frame would look exactly like the last one: nothing is loading,
+// animating or counting down, and hover only changes on input. The loop then
+// sleeps in waitEvent() instead of rendering identical frames.
+bool Game::canIdle() const {
+    if (isLoading() || replaying)
+        return false;
+    if (logic.gameState == GameLogic::IN_GAME)
+        return !logic.showingFeedback && !explosion.isPlaying && shooter.bullets.size() == 0;
+    return true;
+}
+
+// --alloc-check: report a frame that allocated in update or render although it showed
+// the same question and feedback state as the two frames before it. Debug builds
+// stop at the first one. Profile recording allocates as it goes, so it skips the check.
+void Game::checkSteadyAllocations(uint64_t allocations) {
+    FrameState current = { logic.gameState, logic.currentLevel, logic.currentQuestionIndex, logic.showingFeedback };
+    steadyFrames = current == lastFrameState ? steadyFrames + 1 : 0;
+    lastFrameState = current;
+    if (current.state != GameLogic::IN_GAME || steadyFrames < 2 || allocations == 0 || profiler.isRecording())
+        return;
+    std::cerr << "Error: " << allocations << " heap allocation(s) in a steady-state IN_GAME frame (tick " << simTick << ").\n";
+    assert(!"heap allocation in a steady-state IN_GAME frame");
+}
+
 void Game::run() {
     while (window.isOpen()) {
-        processEvents();
-        update();
-        render();
+        assets.pollUploads();
+        if (assetReport && !assets.isLoading()) {
+            assets.printReport(std::cout);
+            assetReport = false;
+        }
+
+        // Idle: block until input arrives, then go straight back to full rate
+        bool idle = canIdle();
+        profiler.setMode(idle ? "idle (waitEvent)" : "active");
+        if (idle) {
+            sf::Event event;
+            if (window.waitEvent(event)) {
+                // The steps slept through are skipped, not simulated. Counting them keeps the
+                // question timer right and stamps the event where a replay, which never idles, reaches it.
+                uint32_t steps = static_cast<uint32_t>((frameAccumulator + frameClock.getElapsedTime().asSeconds()) / SIM_TIME_STEP);
+                simTick += steps;
+                logic.skipSteps(steps);
+                dispatchEvent(event);
+            }
+            frameClock.restart();
+            frameAccumulator = 0.f;
+        }
+
+        profiler.beginFrame();
+        if (!glyphWarmer.done()) {
+            FrameProfiler::Scope scope(profiler, "prewarmGlyphs");
+            glyphWarmer.step(GLYPH_WARM_BUDGET);
+        }
+        {
+            FrameProfiler::Scope scope(profiler, "processEvents");
+            processEvents();
+        }
+
+        // Allocations in update and render; event polling, the overlay and the driver are left out
+        uint64_t hotAllocations = 0;
+
+        // Run as many fixed steps as real time has covered, then draw the remainder interpolated
+        frameAccumulator += std::min(frameClock.restart().asSeconds(), MAX_FRAME_TIME);
+        while (frameAccumulator >= SIM_TIME_STEP && window.isOpen()) {
+            FrameProfiler::Scope scope(profiler, "update");
+            if (replaying)
+                feedReplay(); // recorded events land between the same steps as when recorded
+            uint64_t before = allocationsSoFar();
+            update(SIM_TIME_STEP);
+            hotAllocations += allocationsSoFar() - before;
+            ++simTick;
+            frameAccumulator -= SIM_TIME_STEP;
+        }
+        {
+            FrameProfiler::Scope scope(profiler, "render");
+            uint64_t before = allocationsSoFar();
+            render(window, frameAccumulator / SIM_TIME_STEP);
+            hotAllocations += allocationsSoFar() - before;
+            profiler.drawOverlay(window, *font);
+        }
+        {
+            FrameProfiler::Scope scope(profiler, "display"); // includes waiting for vsync
+            window.display();
+        }
+        profiler.endFrame();
+        if (allocationCheck)
+            checkSteadyAllocations(hotAllocations);
+    }
+    voices.stopAll();
+    if (!profilePath.empty())
+        profiler.save(profilePath);
+    saveProgress();
+    saveWriter.flush();
+    if (!recordPath.empty() && !replaying) {
+        inputLog.header.endTick = simTick;
+        inputLog.save(recordPath);
     }
 }
 
-int main() {
-    Game game;
+// One benchmark scenario: setup runs once, step injects the scripted input for a frame
+struct BenchScenario {
+    const char* name;
+    std::function<void()> setup;
+    std::function<void(int frame)> step;
+};
+
+// Run every scenario update-only and with offscreen rendering and add the results to
+// report. Both modes need a window and GL context, so a display; the logic-only
+// scenarios that run without one are HeadlessSimulator::benchmark().
+bool Game::runBenchmark(BenchReport& report) {
+    if (!window.isOpen())
+        return false;
+
+    // Wait for the background asset loads so they don't land inside a measurement
+    while (assets.isLoading()) {
+        assets.pollUploads();
+        sf::sleep(sf::milliseconds(1));
+    }
+    assets.pollUploads();
+    glyphWarmer.step(1e9f);
+
+    sf::RenderTexture offscreen;
+    if (!offscreen.create(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        std::cerr << "Error: benchmark needs render texture support." << std::endl;
+        return false;
+    }
+
+    // Synthetic mouse input goes through the normal event handler
+    auto mouseMove = [this](int x, int y) {
+        sf::Event event;
+        event.type = sf::Event::MouseMoved;
+        event.mouseMove.x = x;
+        event.mouseMove.y = y;
+        handleEvent(event);
+    };
+    auto click = [this](sf::Vector2f position) {
+        sf::Event event;
+        event.type = sf::Event::MouseButtonPressed;
+        event.mouseButton.button = sf::Mouse::Left;
+        event.mouseButton.x = static_cast<int>(position.x);
+        event.mouseButton.y = static_cast<int>(position.y);
+        handleEvent(event);
+    };
+    auto wheel = [this](float delta) {
+        sf::Event event;
+        event.type = sf::Event::MouseWheelScrolled;
+        event.mouseWheelScroll.wheel = sf::Mouse::VerticalWheel;
+        event.mouseWheelScroll.delta = delta;
+        event.mouseWheelScroll.x = mousePosition.x;
+        event.mouseWheelScroll.y = mousePosition.y;
+        handleEvent(event);
+    };
+    auto startPlaying = [this]() {
+        for (size_t i = 0; i < logic.bank.levelCount(); ++i)
+            logic.levelUnlocked[i] = true;
+        if (logic.startLevel(0)) {
+            loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
+            updateScoreText();
+            updateLivesText();
+        }
+    };
+
+    std::vector<BenchScenario> scenarios;
+    scenarios.push_back({ "menu_idle", [this]() {
+        logic.returnToMenu();
+        setupMenu();
+    }, [](int) {} });
+
+    scenarios.push_back({ "level_select_500", [this]() {
+        // 500 generated levels of 5 questions each
+        std::stringstream text;
+        for (int l = 0; l < 500; ++l) {
+            text << "[Benchmark level " << l + 1 << "\\nGenerated]\n";
+            for (int q = 0; q < 5; ++q)
+                text << "? Question " << q + 1 << "\n* Right\n- Wrong\n- Also wrong\n- Still wrong\n";
+        }
+        logic.bank.loadText(text, "<benchmark levels>");
+        logic.resetProgress();
+        for (size_t i = 0; i < logic.bank.levelCount(); i += 2)
+            logic.levelUnlocked[i] = true;
+        logic.openLevelSelection();
+        levelScroll = 0.f;
+        setupLevelSelection();
+    }, [&](int frame) {
+        mouseMove(WINDOW_WIDTH / 2 + (frame * 7) % 300 - 150, 80 + (frame * 13) % 520);
+        if (frame % 10 == 0)
+            wheel((frame / 600) % 2 == 0 ? -3.f : 3.f);
+    } });
+
+    scenarios.push_back({ "rapid_answering", [&]() {
+        logic.loadLevels(questionBankPath);
+        startPlaying();
+    }, [&](int frame) {
+        if (logic.gameState != GameLogic::IN_GAME) {
+            startPlaying();
+            return;
+        }
+        if (logic.showingFeedback) return;
+        const Question* q = logic.currentQuestion();
+        if (!q) return;
+        int option = frame % 5 == 0 ? (q->correctOptionIndex + 1) % q->optionCount : q->correctOptionIndex;
+        click(optionBoxes[option].getPosition() + optionBoxes[option].getSize() / 2.f);
+    } });
+
+    scenarios.push_back({ "bullet_stress", [&]() {
+        startPlaying();
+    }, [&](int frame) {
+        if (logic.gameState != GameLogic::IN_GAME) startPlaying();
+        for (int i = 0; i < 200; ++i) shooter.shoot();
+        if (frame % 20 == 0)
+            explosion.start(sf::Vector2f(100.f + (frame * 37) % 800, 200.f + (frame * 17) % 300));
+    } });
+
+    std::vector<double> frameMs(BENCH_FRAMES);
+    std::vector<uint64_t> frameAllocs(BENCH_FRAMES);
+
+    for (int mode = 0; mode < 2; ++mode) {
+        const bool rendering = mode == 1;
+        for (const BenchScenario& scenario : scenarios) {
+            scenario.setup();
+            shooter.bullets.clear();
+            for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+                uint64_t allocsBefore = allocationsSoFar();
+                auto start = std::chrono::steady_clock::now();
+
+                scenario.step(frame);
+                update(SIM_TIME_STEP);
+                ++simTick;
+                if (rendering) {
+                    render(offscreen, 1.f);
+                    offscreen.display();
+                }
+
+                frameMs[frame] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                frameAllocs[frame] = allocationsSoFar() - allocsBefore;
+            }
+            report.add(std::string(scenario.name) + (rendering ? "/render" : "/update"), frameMs, frameAllocs);
+        }
+    }
+    return true;
+}
+
+// --- HeadlessSimulator Class ---
+// Plays GameLogic sessions from a script or with an automatic player. It never
+// opens a window, rasterizes a font or touches the audio device, so CI boxes can
+// simulate thousands of sessions per second against the same logic as the game.
+class HeadlessSimulator {
+public:
+    // One scripted player action, mirroring a click or key press in the windowed game
+    struct Command {
+        enum Type { START, RULES, BACK, ESCAPE, LEVEL, ANSWER, WAIT };
+        Type type;
+        int index;
+        float seconds;
+    };
+
+    HeadlessSimulator(unsigned seed, const std::string& questionBankPath)
+        : rng(seed), answers(0), correctAnswers(0), gameOvers(0), levelsCompleted(0), levelsUnlocked(0),
+        quit(false), bankLoadMs(0.0) {
+        logic.seed(seed);
+        auto begin = std::chrono::steady_clock::now();
+        logic.loadLevels(questionBankPath);
+        bankLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // Script format: one command per line, '#' starts a comment.
+    //   start | rules | back | escape | level <n> | answer <n> | wait <seconds>
+    bool loadScript(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Error opening headless script: " << path << std::endl;
+            return false;
+        }
+        script.clear();
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos)
+                line.erase(comment);
+            std::istringstream iss(line);
+            std::string word;
+            if (!(iss >> word))
+                continue;
+
+            Command cmd = { Command::START, 0, 0.f };
+            bool ok = true;
+            if (word == "start") cmd.type = Command::START;
+            else if (word == "rules") cmd.type = Command::RULES;
+            else if (word == "back") cmd.type = Command::BACK;
+            else if (word == "escape") cmd.type = Command::ESCAPE;
+            else if (word == "level") { cmd.type = Command::LEVEL; ok = static_cast<bool>(iss >> cmd.index); }
+            else if (word == "answer") { cmd.type = Command::ANSWER; ok = static_cast<bool>(iss >> cmd.index); }
+            else if (word == "wait") { cmd.type = Command::WAIT; ok = static_cast<bool>(iss >> cmd.seconds); }
+            else ok = false;
+
+            if (!ok) {
+                std::cerr << "Error in headless script " << path << " line " << lineNumber << ": " << line << std::endl;
+                return false;
+            }
+            script.push_back(cmd);
+        }
+        return true;
+    }
+
+    // Play the given number of sessions and print a summary
+    void run(int sessions) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int s = 0; s < sessions; ++s) {
+            logic.resetProgress();
+            quit = false;
+            if (script.empty())
+                playAuto();
+            else
+                playScript();
+            levelsUnlocked += std::count(logic.levelUnlocked.begin(), logic.levelUnlocked.end(), true);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        std::cout << "Question bank: " << logic.bank.levelCount() << " levels, " << logic.bank.questionCount()
+            << " questions, " << logic.bank.byteSize() << " bytes (loaded in " << bankLoadMs << " ms)\n"
+            << "Headless run: " << sessions << " session(s) in " << ms << " ms ("
+            << (ms > 0.0 ? sessions * 1000.0 / ms : 0.0) << " sessions/s)\n"
+            << "  answers: " << answers << " (" << correctAnswers << " correct), game overs: " << gameOvers
+            << ", levels completed: " << levelsCompleted << "\n"
+            << "  average levels unlocked: " << (sessions > 0 ? double(levelsUnlocked) / sessions : 0.0)
+            << " / " << logic.bank.levelCount() << "\n"
+            << "Last session: state=" << stateName(logic.gameState) << ", score=" << logic.score
+            << ", lives=" << logic.lives << std::endl;
+    }
+
+    // Logic-only --bench scenarios. They need no window or GL context, so unlike the
+    // Game scenarios they also run on CI machines without a display.
+    void benchmark(BenchReport& report) {
+        std::vector<double> frameMs(BENCH_FRAMES);
+        std::vector<uint64_t> frameAllocs(BENCH_FRAMES);
+
+        // One whole auto-played session per sample
+        for (int i = 0; i < BENCH_FRAMES; ++i) {
+            uint64_t allocsBefore = allocationsSoFar();
+            auto start = std::chrono::steady_clock::now();
+            logic.resetProgress();
+            quit = false;
+            playAuto();
+            frameMs[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            frameAllocs[i] = allocationsSoFar() - allocsBefore;
+        }
+        report.add("auto_session/logic", frameMs, frameAllocs);
+
+        // One fixed step per sample, answering every question as soon as it is up
+        logic.resetProgress();
+        for (int i = 0; i < BENCH_FRAMES; ++i) {
+            uint64_t allocsBefore = allocationsSoFar();
+            auto start = std::chrono::steady_clock::now();
+            if (logic.gameState != GameLogic::IN_GAME) {
+                std::fill(logic.levelUnlocked.begin(), logic.levelUnlocked.end(), true);
+                if (logic.startLevel(0))
+                    logic.loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
+            }
+            else if (!logic.showingFeedback) {
+                const Question* q = logic.currentQuestion();
+                answer(i % 5 == 0 ? (q->correctOptionIndex + 1) % q->optionCount : q->correctOptionIndex);
+            }
+            wait(SIM_TIME_STEP);
+            frameMs[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            frameAllocs[i] = allocationsSoFar() - allocsBefore;
+        }
+        report.add("rapid_answering/logic", frameMs, frameAllocs);
+    }
+
+private:
+    GameLogic logic;
+    std::vector<Command> script;
+    std::mt19937 rng;
+    long long answers;
+    long long correctAnswers;
+    long long gameOvers;
+    long long levelsCompleted;
+    long long levelsUnlocked;
+    bool quit;
+    double bankLoadMs;
+
+    static const char* stateName(GameLogic::GameState state) {
+        switch (state) {
+        case GameLogic::MENU: return "MENU";
+        case GameLogic::LEVEL_SELECTION: return "LEVEL_SELECTION";
+        case GameLogic::RULES: return "RULES";
+        case GameLogic::IN_GAME: return "IN_GAME";
+        case GameLogic::GAME_OVER: return "GAME_OVER";
+        }
+        return "UNKNOWN";
+    }
+
+    // Apply one command with the same state checks as the windowed event handlers
+    void execute(const Command& cmd) {
+        GameLogic::GameState state = logic.gameState;
+        switch (cmd.type) {
+        case Command::START:
+            if (state == GameLogic::MENU) logic.openLevelSelection();
+            break;
+        case Command::RULES:
+            if (state == GameLogic::MENU) logic.openRules();
+            break;
+        case Command::BACK:
+            if (state == GameLogic::LEVEL_SELECTION || state == GameLogic::RULES || state == GameLogic::GAME_OVER)
+                logic.returnToMenu();
+            break;
+        case Command::ESCAPE:
+            if (state == GameLogic::MENU) quit = true;
+            else logic.returnToMenu();
+            break;
+        case Command::LEVEL:
+            if (state == GameLogic::LEVEL_SELECTION && logic.startLevel(cmd.index))
+                logic.loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
+            break;
+        case Command::ANSWER:
+            answer(cmd.index);
+            break;
+        case Command::WAIT:
+            wait(cmd.seconds);
+            break;
+        }
+    }
+
+    void answer(int option) {
+        if (logic.gameState != GameLogic::IN_GAME || logic.showingFeedback)
+            return;
+        GameLogic::AnswerResult result = logic.checkAnswer(option);
+        if (result == GameLogic::ANSWER_INVALID)
+            return;
+        answers++;
+        if (result == GameLogic::ANSWER_CORRECT) correctAnswers++;
+        if (result == GameLogic::ANSWER_GAME_OVER) gameOvers++;
+    }
+
+    // Advance simulated time in frame-sized steps, reacting like Game::update does
+    void wait(float seconds) {
+        for (float t = 0.f; t < seconds; t += SIM_TIME_STEP) {
+            switch (logic.update(SIM_TIME_STEP)) {
+            case GameLogic::FEEDBACK_NEXT_QUESTION:
+                logic.loadQuestion(logic.currentLevel, logic.currentQuestionIndex);
+                break;
+            case GameLogic::FEEDBACK_LEVEL_COMPLETE:
+                levelsCompleted++;
+                break;
+            case GameLogic::FEEDBACK_RETURN_TO_MENU:
+            case GameLogic::FEEDBACK_PENDING:
+                break;
+            }
+        }
+    }
+
+    void playScript() {
+        for (const Command& cmd : script) {
+            if (quit) break;
+            execute(cmd);
+        }
+    }
+
+    // Repeatedly play the highest unlocked level until the last one is cleared
+    void playAuto() {
+        if (logic.bank.levelCount() == 0)
+            return;
+        std::uniform_real_distribution<float> chance(0.f, 1.f);
+        const int lastLevel = static_cast<int>(logic.bank.levelCount()) - 1;
+        const size_t maxAttempts = logic.bank.levelCount() * 4;
+
+        for (size_t attempt = 0; attempt < maxAttempts; ++attempt) {
+            int level = lastLevel;
+            while (level > 0 && !logic.isLevelUnlocked(level)) level--;
+
+            logic.openLevelSelection();
+            if (!logic.startLevel(level) || !logic.loadQuestion(logic.currentLevel, logic.currentQuestionIndex))
+                break;
+
+            while (logic.gameState == GameLogic::IN_GAME) {
+                const Question* q = logic.currentQuestion();
+                int optionCount = static_cast<int>(q->optionCount);
+                int option = q->correctOptionIndex;
+                if (optionCount > 1 && chance(rng) >= AUTO_PLAYER_ACCURACY) {
+                    option = std::uniform_int_distribution<int>(0, optionCount - 2)(rng);
+                    if (option >= q->correctOptionIndex) option++;
+                }
+                answer(option);
+                if (logic.gameState == GameLogic::GAME_OVER) {
+                    logic.returnToMenu();
+                    break;
+                }
+                wait(FEEDBACK_DURATION + SIM_TIME_STEP);
+            }
+            if (level == lastLevel && logic.lives > 0 && logic.gameState == GameLogic::LEVEL_SELECTION)
+                break;
+        }
+        logic.returnToMenu();
+    }
+};
+
+// Command-line switches:
+//   --headless [script]   run the game logic without a window (auto player when no script)
+//   --sessions <n>        number of headless sessions to play (default 1)
+//   --seed <n>            seed for the headless auto player (default 1) or the windowed session (default: clock)
+//   --bank <path>         question bank file (text or compiled) to load instead of QUESTION_BANK_PATH
+//   --compile-bank <text> <binary>   compile a text question bank into the binary format and exit
+//   --asset-report        print memory use and load time of every loaded asset
+//   --profile <file>      record frame timings and write them on exit (CSV, or Chrome trace if <file> ends in .json)
+//   --record <file>       record the session's input for --replay, written on exit
+//   --replay <file>       play back a recorded session and exit when it ends
+//   --bench [file]        run the benchmark scenarios and write JSON results to file (default stdout);
+//                         with --headless only the logic scenarios, which need no display
+//   --bench-baseline <file>   exit with 1 if a scenario regressed against this baseline
+//   --bench-save-baseline <file>  write this run's results as a baseline for --bench-baseline
+//   --alloc-check         report heap allocations in steady-state IN_GAME frames (debug builds assert)
+//   --player <name>       name stamped on the answers written to the answer journal
+int main(int argc, char* argv[]) {
+    bool headless = false;
+    std::string scriptPath;
+    GameOptions options;
+    std::string benchOutput;
+    std::string benchBaseline;
+    std::string benchSaveBaseline;
+    int sessions = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                scriptPath = argv[++i];
+        }
+        else if (arg == "--sessions" && i + 1 < argc) {
+            sessions = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            options.seedGiven = true;
+        }
+        else if (arg == "--bank" && i + 1 < argc) {
+            options.questionBankPath = argv[++i];
+        }
+        else if (arg == "--asset-report") {
+            options.assetReport = true;
+        }
+        else if (arg == "--profile" && i + 1 < argc) {
+            options.profilePath = argv[++i];
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        }
+        else if (arg == "--bench") {
+            options.benchmark = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchOutput = argv[++i];
+        }
+        else if (arg == "--bench-baseline" && i + 1 < argc) {
+            benchBaseline = argv[++i];
+        }
+        else if (arg == "--bench-save-baseline" && i + 1 < argc) {
+            benchSaveBaseline = argv[++i];
+        }
+        else if (arg == "--alloc-check") {
+            options.allocationCheck = true;
+        }
+        else if (arg == "--player" && i + 1 < argc) {
+            options.player = argv[++i];
+        }
+        else if (arg == "--compile-bank" && i + 2 < argc) {
+            QuestionBank bank;
+            if (!bank.loadText(argv[i + 1]) || !bank.save(argv[i + 2]))
+                return 1;
+            std::cout << "Compiled " << bank.levelCount() << " levels, " << bank.questionCount() << " questions into "
+                << argv[i + 2] << " (" << bank.byteSize() << " bytes, version " << QUESTION_BANK_VERSION
+                << ", checksum " << std::hex << bank.checksum() << std::dec << ")" << std::endl;
+            return 0;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.benchmark) {
+        BenchReport report;
+        {
+            HeadlessSimulator simulator(options.seedGiven ? options.seed : 1, options.questionBankPath);
+            simulator.benchmark(report);
+        }
+        if (!headless) {
+            Game game(options);
+            if (!game.runBenchmark(report))
+                return 1;
+        }
+        return report.finish(benchOutput, benchBaseline, benchSaveBaseline);
+    }
+
+    if (headless) {
+        HeadlessSimulator simulator(options.seedGiven ? options.seed : 1, options.questionBankPath);
+        if (!scriptPath.empty() && !simulator.loadScript(scriptPath))
+            return 1;
+        simulator.run(sessions);
+        return 0;
+    }
+
+    Game game(options);
     game.run();
     return 0;
 }